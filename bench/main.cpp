@@ -0,0 +1,546 @@
+#include <chrono>
+#include "mock_chain.hpp"
+
+//Probes of a TRACE_PROBES bench build measure host time in nanoseconds
+#define PROBE_CLOCK() std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()
+#include "token.pc.cpp"
+#include "state_image.hpp"
+#include "population.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+//Native benchmark scenarios for token.pc.
+//Every iteration restores the seeded state, runs one scenario and reports wall time,
+//DB operations and inline actions sent by the contract.
+
+const name SELF("token.pc");
+const name ALICE("alice");
+const name BOB("bob");
+const name CAROL("carol");
+const name DAVE("dave");
+const name DEPOSITOR("depositor");
+
+struct scenario
+{
+    std::string name;
+    std::function<void()> setup;
+    std::function<void()> run;
+};
+
+template <typename F>
+void as_contract(const name &receiver, F &&f)
+{
+    auto &chain = mock_chain::get();
+    auto previous = chain.receiver;
+    chain.receiver = receiver.value;
+    f();
+    chain.receiver = previous;
+}
+
+template <typename F>
+void run_action(const name &code, F &&f)
+{
+    as_contract(SELF, [&]() {
+        token contract(SELF, code, datastream<const char *>(nullptr, 0));
+        f(contract);
+    });
+    mock_chain::get().reset_handles();
+}
+
+void seed_token()
+{
+    run_action(SELF, [](token &c) {
+        c.create_token(SELF, asset(100000000000000000, USDCASH));
+        c.add_swap_cash(asset(usdcash_package_amount, USDCASH));
+        c.add_swap_income(extended_asset(asset(10000, USDT.get_symbol()), USDT.get_contract()));
+    });
+}
+
+void seed_foreign_account(const extended_symbol &token, const name &owner, const int64_t &amount)
+{
+    as_contract(token.get_contract(), [&]() {
+        accounts _accounts(token.get_contract(), owner.value);
+        _accounts.emplace(token.get_contract(), [&](auto &a) {
+            a.balance = asset(amount, token.get_symbol());
+        });
+    });
+}
+
+void seed_pool()
+{
+    as_contract(SWAP_PCASH_ACCOUNT, []() {
+        pools _pools(SWAP_PCASH_ACCOUNT, SWAP_PCASH_ACCOUNT.value);
+        _pools.emplace(SWAP_PCASH_ACCOUNT, [](auto &p) {
+            p.id = 0;
+            p.code = symbol_code("MLNKUSD");
+            p.token1 = extended_asset(asset(100000000, USDT.get_symbol()), USDT.get_contract());
+            p.token2 = extended_asset(asset(1000000000000, MLNK.get_symbol()), MLNK.get_contract());
+        });
+    });
+}
+
+void migrate(const uint32_t &max_rows)
+{
+    run_action(SELF, [&](token &c) {
+        c.migrate_deposits(max_rows);
+    });
+}
+
+//Adds every deposit to the rdmtree, as the migration does for rows created before it
+void seed_redemption_book()
+{
+    as_contract(SELF, []() {
+        deposits _deposits(SELF, SELF.value);
+        redemption_book book(SELF);
+        for (const auto &d : _deposits)
+            book.insert(d);
+        book.save();
+    });
+}
+
+void seed_deposits(const uint32_t &count)
+{
+    as_contract(SELF, [&]() {
+        deposits _deposits(SELF, SELF.value);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            _deposits.emplace(SELF, [&](auto &a) {
+                a.id = i;
+                a.owner = DEPOSITOR;
+                a.mlnk_amount = 100000000 + i;
+                a.usdt_amount = 10000;
+                a.cash_amount = 100000;
+                a.creation_date = time_point_sec(current_time_point().sec_since_epoch());
+            });
+        }
+    });
+    seed_redemption_book();
+}
+
+//Deposit row in the layout with three full assets, used to seed tables that still need the migration
+struct legacy_place
+{
+    uint64_t id;
+    name owner;
+    asset mlnk_in;
+    asset usdt_in;
+    asset token_out;
+    time_point_sec creation_date;
+
+    uint64_t primary_key() const { return id; }
+    uint64_t owner_key() const { return owner.value; }
+    uint128_t mlnk_in_and_date_key() const { return ((uint128_t)mlnk_in.amount << 64)|(uint128_t)creation_date.sec_since_epoch(); }
+
+    EOSLIB_SERIALIZE(legacy_place, (id)(owner)(mlnk_in)(usdt_in)(token_out)(creation_date))
+};
+using legacy_deposits = multi_index<name("deposits"), legacy_place,
+                                    indexed_by<name("bymlnkdate"), const_mem_fun<legacy_place, uint128_t, &legacy_place::mlnk_in_and_date_key>>,
+                                    indexed_by<name("byowner"), const_mem_fun<legacy_place, uint64_t, &legacy_place::owner_key>>>;
+
+void seed_legacy_deposits(const uint32_t &count)
+{
+    as_contract(SELF, [&]() {
+        legacy_deposits _deposits(SELF, SELF.value);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            _deposits.emplace(SELF, [&](auto &a) {
+                a.id = i;
+                a.owner = DEPOSITOR;
+                a.mlnk_in = asset(100000000 + i, MLNK.get_symbol());
+                a.usdt_in = asset(10000, USDT.get_symbol());
+                a.token_out = asset(100000, USDCASH);
+                a.creation_date = time_point_sec(current_time_point().sec_since_epoch());
+            });
+        }
+
+        deposits _packed(SELF, SELF.value);
+        const auto &row = _packed.get(count - 1);
+        check(row.mlnk_amount == 100000000 + count - 1 && row.usdt_amount == 10000 && row.cash_amount == 100000,
+              "seed_legacy_deposits : legacy row is not decoded");
+    });
+}
+
+void issue(const name &to, const int64_t &amount)
+{
+    run_action(SELF, [&](token &c) {
+        c.issue_token(to, asset(amount, USDCASH), "");
+    });
+}
+
+void prepare_deposit(const name &owner)
+{
+    seed_foreign_account(USDT, owner, 0);
+    seed_foreign_account(MLNK, owner, 0);
+    run_action(SELF, [&](token &c) {
+        c.open_account(owner, USDCASH, owner);
+    });
+
+    transaction trx;
+    trx.actions.emplace_back(permission_level{owner, name("active")}, USDT.get_contract(), name("transfer"),
+                             std::make_tuple(owner, SELF, asset(10000, USDT.get_symbol()), std::string("")));
+    trx.actions.emplace_back(permission_level{owner, name("active")}, MLNK.get_contract(), name("transfer"),
+                             std::make_tuple(owner, SELF, asset(100000000, MLNK.get_symbol()), std::string("")));
+    mock_chain::get().transaction = pack(trx);
+}
+
+void run_deposit(const name &owner)
+{
+    run_action(USDT.get_contract(), [&](token &c) {
+        c.on_transfer(owner, SELF, asset(10000, USDT.get_symbol()), "");
+    });
+    run_action(MLNK.get_contract(), [&](token &c) {
+        c.on_transfer(owner, SELF, asset(100000000, MLNK.get_symbol()), "");
+    });
+}
+
+name holder_name(const uint32_t &i)
+{
+    std::string str = "holder";
+    str += char('a' + i / 26);
+    str += char('a' + i % 26);
+    return name(str);
+}
+
+std::vector<scenario> make_scenarios()
+{
+    std::vector<scenario> result;
+
+    result.push_back({"transfer",
+                      []() {
+                          seed_token();
+                          issue(ALICE, 1000000000);
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(ALICE, BOB, asset(100000, USDCASH), "");
+                          });
+                      }});
+
+    result.push_back({"transfermany/100",
+                      []() {
+                          seed_token();
+                          issue(ALICE, 1000000000);
+                      },
+                      []() {
+                          std::vector<transfer_record> transfers;
+                          for (uint32_t i = 0; i < 100; ++i)
+                              transfers.push_back({holder_name(i), asset(1000, USDCASH), ""});
+
+                          run_action(SELF, [&](token &c) {
+                              c.transfer_many(ALICE, transfers);
+                          });
+                      }});
+
+    result.push_back({"deposit_pair",
+                      []() {
+                          seed_token();
+                          seed_pool();
+                          prepare_deposit(ALICE);
+                      },
+                      []() {
+                          run_deposit(ALICE);
+                      }});
+
+    result.push_back({"deposit_staged",
+                      []() {
+                          seed_token();
+                          seed_pool();
+                          seed_foreign_account(USDT, ALICE, 0);
+                          seed_foreign_account(MLNK, ALICE, 0);
+                          run_action(SELF, [](token &c) {
+                              c.open_account(ALICE, USDCASH, ALICE);
+                          });
+                      },
+                      []() {
+                          run_action(USDT.get_contract(), [](token &c) {
+                              c.on_transfer(ALICE, SELF, asset(10000, USDT.get_symbol()), std::string(staged_deposit_memo));
+                          });
+                          run_action(MLNK.get_contract(), [](token &c) {
+                              c.on_transfer(ALICE, SELF, asset(100000000, MLNK.get_symbol()), std::string(staged_deposit_memo));
+                          });
+                      }});
+
+    result.push_back({"transfer_notify/spam",
+                      []() {
+                          seed_token();
+                          mock_chain::get().action_data = pack(std::make_tuple(name("spammer"), SELF, asset(1, symbol("SPAM", 4)),
+                                                                               std::string(200, 'x')));
+                      },
+                      []() {
+                          as_contract(SELF, []() {
+                              apply(SELF.value, name("spam.token").value, name("transfer").value);
+                          });
+                          mock_chain::get().reset_handles();
+                      }});
+
+    result.push_back({"redemption_10k/transfer",
+                      []() {
+                          seed_token();
+                          seed_foreign_account(USDT, ALICE, 0);
+                          seed_deposits(10000);
+                          issue(ALICE, 1000000000);
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(ALICE, SELF, asset(1000000000, USDCASH), "usdt");
+                          });
+                      }});
+
+    result.push_back({"redemption_10k/processrdm",
+                      []() {
+                          seed_token();
+                          seed_foreign_account(USDT, ALICE, 0);
+                          seed_deposits(10000);
+                          issue(ALICE, 1000000000);
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(ALICE, SELF, asset(1000000000, USDCASH), "usdt");
+                          });
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.process_redemptions(BOB, max_redemption_rows);
+                          });
+                      }});
+
+    result.push_back({"migration/1000_legacy",
+                      []() {
+                          seed_token();
+                          seed_legacy_deposits(1000);
+                      },
+                      []() {
+                          migrate(1000);
+                      }});
+
+    result.push_back({"redemption_1k_legacy/transfer",
+                      []() {
+                          seed_token();
+                          seed_foreign_account(USDT, ALICE, 0);
+                          seed_legacy_deposits(1000);
+                          seed_redemption_book();
+                          issue(ALICE, 1000000000);
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(ALICE, SELF, asset(1000000000, USDCASH), "usdt");
+                          });
+                      }});
+
+    result.push_back({"get_royalties/50_holders",
+                      []() {
+                          seed_token();
+                          for (uint32_t i = 0; i < 50; ++i)
+                          {
+                              run_action(SELF, [&](token &c) {
+                                  c.add_royalty_holder(holder_name(i), asset(20, inh_percent));
+                              });
+                          }
+                          issue(SELF, 100000000);
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.get_royalties(ALICE, 50);
+                          });
+                      }});
+
+    result.push_back({"inheritance_distribution",
+                      []() {
+                          seed_token();
+                          issue(ALICE, 100000000);
+                          run_action(SELF, [](token &c) {
+                              c.update_inheritors(ALICE, {{BOB, asset(300, inh_percent)}, {CAROL, asset(300, inh_percent)}, {DAVE, asset(400, inh_percent)}});
+                          });
+                          mock_chain::get().now += (uint64_t)(initial_period + 1) * 1000000;
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.distribute_inheritance(BOB, ALICE, USDCASH.code());
+                          });
+                      }});
+
+    return result;
+}
+
+//Scaling scenarios run against a generated population with the given number of accounts and deposits
+std::vector<scenario> make_scaling_scenarios()
+{
+    std::vector<scenario> result;
+
+    result.push_back({"transfer",
+                      []() {},
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(population_name(0), population_name(1), asset(1000, USDCASH), "");
+                          });
+                      }});
+
+    result.push_back({"deposit",
+                      []() {
+                          prepare_deposit(ALICE);
+                      },
+                      []() {
+                          run_deposit(ALICE);
+                      }});
+
+    result.push_back({"redemption",
+                      []() {
+                          seed_foreign_account(USDT, ALICE, 0);
+                          issue(ALICE, 1000000000);
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.transfer_token(ALICE, SELF, asset(1000000000, USDCASH), "usdt");
+                          });
+                      }});
+
+    result.push_back({"swap_back",
+                      []() {
+                          name owner;
+                          as_contract(SELF, [&]() {
+                              deposits _deposits(SELF, SELF.value);
+                              owner = _deposits.get(0).owner;
+                          });
+                          seed_foreign_account(USDT, owner, 0);
+                          seed_foreign_account(MLNK, owner, 0);
+                          issue(owner, usdcash_package_amount);
+                      },
+                      []() {
+                          name owner;
+                          as_contract(SELF, [&]() {
+                              deposits _deposits(SELF, SELF.value);
+                              owner = _deposits.get(0).owner;
+                          });
+                          run_action(SELF, [&](token &c) {
+                              c.swap_back(owner, asset(usdcash_package_amount, USDCASH), 0);
+                          });
+                      }});
+
+    result.push_back({"inheritance_distribution",
+                      []() {
+                          mock_chain::get().now += (uint64_t)(initial_period + 1) * 1000000;
+                      },
+                      []() {
+                          run_action(SELF, [](token &c) {
+                              c.distribute_inheritance(BOB, population_name(0), USDCASH.code());
+                          });
+                      }});
+
+    return result;
+}
+
+int run_scaling(const uint32_t &iterations, const uint32_t &max_rows, const std::string &image_dir)
+{
+    auto &chain = mock_chain::get();
+    const auto empty_state = chain.save();
+
+    int failed = 0;
+    printf("scenario,rows,ns,db_reads,db_writes,inline\n");
+    for (uint32_t rows = 1000; rows <= max_rows; rows *= 10)
+    {
+        chain.restore(empty_state);
+        population_config config{rows, rows};
+        auto key = population_key(config);
+        auto image = image_dir + "/" + key + ".img";
+        if (!load_state_image(chain, image, key))
+        {
+            seed_token();
+            seed_pool();
+            generate_population(SELF, config);
+            save_state_image(chain, image, key);
+        }
+        const auto population_state = chain.save();
+
+        for (const auto &s : make_scaling_scenarios())
+        {
+            try
+            {
+                chain.restore(population_state);
+                s.setup();
+                const auto seeded_state = chain.save();
+
+                double total_ns = 0;
+                for (uint32_t i = 0; i < iterations; ++i)
+                {
+                    chain.restore(seeded_state);
+                    chain.reset_counters();
+
+                    auto start = std::chrono::steady_clock::now();
+                    s.run();
+                    auto stop = std::chrono::steady_clock::now();
+                    total_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+                }
+                printf("%s,%u,%.0f,%llu,%llu,%llu\n", s.name.c_str(), rows, total_ns / iterations,
+                       (unsigned long long)chain.counters.db_reads, (unsigned long long)chain.counters.db_writes,
+                       (unsigned long long)chain.counters.inline_actions);
+            }
+            catch (const std::exception &e)
+            {
+                fprintf(stderr, "%s/%u FAILED: %s\n", s.name.c_str(), rows, e.what());
+                ++failed;
+            }
+        }
+    }
+    return failed;
+}
+
+void report(const scenario &s, const uint32_t &iterations, const double &total_ns, const chain_counters &counters)
+{
+    printf("%-32s %14.0f ns %8u iterations %8llu db_reads %8llu db_writes %6llu inline",
+           s.name.c_str(), total_ns / iterations, iterations,
+           (unsigned long long)counters.db_reads, (unsigned long long)counters.db_writes,
+           (unsigned long long)counters.inline_actions);
+    for (const auto &[action_name, count] : counters.inline_by_action)
+        printf(" %s=%llu", name(action_name).to_string().c_str(), (unsigned long long)count);
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    auto &chain = mock_chain::get();
+    chain.install();
+
+    //token.pc.bench --scale [iterations] [max rows] [image dir]
+    if (argc >= 2 && std::string(argv[1]) == "--scale")
+    {
+        return run_scaling(argc >= 3 ? std::atoi(argv[2]) : 5,
+                           argc >= 4 ? std::atoi(argv[3]) : 1000000,
+                           argc >= 5 ? argv[4] : ".");
+    }
+
+    uint32_t iterations = argc >= 2 ? std::atoi(argv[1]) : 100;
+    std::string filter = argc >= 3 ? argv[2] : "";
+    const auto empty_state = chain.save();
+
+    int failed = 0;
+    for (const auto &s : make_scenarios())
+    {
+        if (!filter.empty() && s.name.find(filter) == std::string::npos)
+            continue;
+
+        try
+        {
+            chain.restore(empty_state);
+            s.setup();
+            const auto seeded_state = chain.save();
+
+            double total_ns = 0;
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                chain.restore(seeded_state);
+                chain.reset_counters();
+
+                auto start = std::chrono::steady_clock::now();
+                s.run();
+                auto stop = std::chrono::steady_clock::now();
+                total_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+            }
+            report(s, iterations, total_ns, chain.counters);
+        }
+        catch (const std::exception &e)
+        {
+            printf("%-32s FAILED: %s\n", s.name.c_str(), e.what());
+            ++failed;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,575 @@
+#pragma once
+#include <eosio/tester.hpp>
+#include <array>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace eosio::native;
+
+//In-memory stand-in for the chain state and the host functions used by token.pc.
+//Iterator handles follow nodeos conventions: -1 means the table does not exist,
+//other negative values are end iterators of existing tables.
+
+using key256 = std::array<uint128_t, 2>;
+
+struct table_id
+{
+    uint64_t code;
+    uint64_t scope;
+    uint64_t table;
+
+    bool operator<(const table_id &other) const
+    {
+        return std::tie(code, scope, table) < std::tie(other.code, other.scope, other.table);
+    }
+    bool operator==(const table_id &other) const
+    {
+        return code == other.code && scope == other.scope && table == other.table;
+    }
+};
+
+struct chain_counters
+{
+    uint64_t db_reads = 0;
+    uint64_t db_writes = 0;
+    uint64_t inline_actions = 0;
+    std::map<uint64_t, uint64_t> inline_by_action;
+};
+
+struct primary_row
+{
+    uint64_t payer;
+    std::vector<char> data;
+};
+
+class handle_registry
+{
+private:
+    std::vector<std::pair<table_id, uint64_t>> iterators;
+    std::vector<table_id> ends;
+
+public:
+    int32_t add(const table_id &table, const uint64_t &primary)
+    {
+        iterators.emplace_back(table, primary);
+        return iterators.size() - 1;
+    }
+
+    int32_t end(const table_id &table)
+    {
+        for (size_t i = 0; i < ends.size(); ++i)
+            if (ends[i] == table)
+                return -int32_t(i) - 2;
+        ends.push_back(table);
+        return -int32_t(ends.size()) - 1;
+    }
+
+    bool is_end(const int32_t &handle) const { return handle < -1; }
+
+    const table_id &end_table(const int32_t &handle) const { return ends.at(-handle - 2); }
+
+    const std::pair<table_id, uint64_t> &get(const int32_t &handle) const { return iterators.at(handle); }
+
+    void clear()
+    {
+        iterators.clear();
+        ends.clear();
+    }
+};
+
+class primary_store
+{
+public:
+    std::map<table_id, std::map<uint64_t, primary_row>> tables;
+    handle_registry handles;
+
+    bool exists(const table_id &table) const
+    {
+        auto it = tables.find(table);
+        return it != tables.end() && !it->second.empty();
+    }
+
+    int32_t make(const table_id &table, std::map<uint64_t, primary_row>::const_iterator it)
+    {
+        return it == tables[table].end() ? handles.end(table) : handles.add(table, it->first);
+    }
+
+    int32_t store(const table_id &table, const uint64_t &payer, const uint64_t &id, const void *data, const uint32_t &len)
+    {
+        auto &rows = tables[table];
+        eosio::check(rows.find(id) == rows.end(), "mock_chain : primary key already exists");
+        rows[id] = primary_row{payer, std::vector<char>((const char *)data, (const char *)data + len)};
+        return handles.add(table, id);
+    }
+
+    primary_row &row(const int32_t &handle)
+    {
+        const auto &[table, id] = handles.get(handle);
+        return tables.at(table).at(id);
+    }
+
+    void remove(const int32_t &handle)
+    {
+        const auto &[table, id] = handles.get(handle);
+        tables.at(table).erase(id);
+    }
+
+    int32_t find(const table_id &table, const uint64_t &id)
+    {
+        if (!exists(table))
+            return -1;
+        return make(table, tables[table].find(id));
+    }
+
+    int32_t lowerbound(const table_id &table, const uint64_t &id)
+    {
+        if (!exists(table))
+            return -1;
+        return make(table, tables[table].lower_bound(id));
+    }
+
+    int32_t upperbound(const table_id &table, const uint64_t &id)
+    {
+        if (!exists(table))
+            return -1;
+        return make(table, tables[table].upper_bound(id));
+    }
+
+    int32_t end(const table_id &table)
+    {
+        return exists(table) ? handles.end(table) : -1;
+    }
+
+    int32_t next(const int32_t &handle, uint64_t *primary)
+    {
+        const auto [table, id] = handles.get(handle);
+        auto it = tables[table].upper_bound(id);
+        if (it == tables[table].end())
+            return handles.end(table);
+        *primary = it->first;
+        return handles.add(table, it->first);
+    }
+
+    int32_t previous(const int32_t &handle, uint64_t *primary)
+    {
+        table_id table = handles.is_end(handle) ? handles.end_table(handle) : handles.get(handle).first;
+        auto &rows = tables[table];
+        auto it = handles.is_end(handle) ? rows.end() : rows.lower_bound(handles.get(handle).second);
+        if (it == rows.begin())
+            return -1;
+        --it;
+        *primary = it->first;
+        return handles.add(table, it->first);
+    }
+};
+
+template <typename K>
+class secondary_store
+{
+public:
+    std::map<table_id, std::set<std::pair<K, uint64_t>>> by_key;
+    std::map<table_id, std::map<uint64_t, std::pair<K, uint64_t>>> by_primary;
+    handle_registry handles;
+
+    using key_iterator = typename std::set<std::pair<K, uint64_t>>::const_iterator;
+
+    bool exists(const table_id &table) const
+    {
+        auto it = by_primary.find(table);
+        return it != by_primary.end() && !it->second.empty();
+    }
+
+    int32_t make(const table_id &table, key_iterator it, K *key, uint64_t *primary)
+    {
+        if (it == by_key[table].end())
+            return handles.end(table);
+        if (key)
+            *key = it->first;
+        *primary = it->second;
+        return handles.add(table, it->second);
+    }
+
+    int32_t store(const table_id &table, const uint64_t &payer, const uint64_t &id, const K &key)
+    {
+        by_key[table].emplace(key, id);
+        by_primary[table][id] = std::make_pair(key, payer);
+        return handles.add(table, id);
+    }
+
+    void update(const int32_t &handle, const uint64_t &payer, const K &key)
+    {
+        const auto [table, id] = handles.get(handle);
+        auto &entry = by_primary[table].at(id);
+        by_key[table].erase(std::make_pair(entry.first, id));
+        by_key[table].emplace(key, id);
+        entry = std::make_pair(key, payer);
+    }
+
+    void remove(const int32_t &handle)
+    {
+        const auto [table, id] = handles.get(handle);
+        auto &rows = by_primary[table];
+        by_key[table].erase(std::make_pair(rows.at(id).first, id));
+        rows.erase(id);
+    }
+
+    int32_t find_primary(const table_id &table, K *key, const uint64_t &id)
+    {
+        if (!exists(table))
+            return -1;
+        auto it = by_primary[table].find(id);
+        if (it == by_primary[table].end())
+            return handles.end(table);
+        *key = it->second.first;
+        return handles.add(table, id);
+    }
+
+    int32_t find_secondary(const table_id &table, const K &key, uint64_t *primary)
+    {
+        if (!exists(table))
+            return -1;
+        auto it = by_key[table].lower_bound(std::make_pair(key, uint64_t(0)));
+        if (it == by_key[table].end() || it->first != key)
+            return handles.end(table);
+        return make(table, it, nullptr, primary);
+    }
+
+    int32_t lowerbound(const table_id &table, K *key, uint64_t *primary)
+    {
+        if (!exists(table))
+            return -1;
+        return make(table, by_key[table].lower_bound(std::make_pair(*key, uint64_t(0))), key, primary);
+    }
+
+    int32_t upperbound(const table_id &table, K *key, uint64_t *primary)
+    {
+        if (!exists(table))
+            return -1;
+        return make(table, by_key[table].upper_bound(std::make_pair(*key, UINT64_MAX)), key, primary);
+    }
+
+    int32_t end(const table_id &table)
+    {
+        return exists(table) ? handles.end(table) : -1;
+    }
+
+    int32_t next(const int32_t &handle, uint64_t *primary)
+    {
+        const auto [table, id] = handles.get(handle);
+        auto &keys = by_key[table];
+        auto it = keys.upper_bound(std::make_pair(by_primary[table].at(id).first, id));
+        return make(table, it, nullptr, primary);
+    }
+
+    int32_t previous(const int32_t &handle, uint64_t *primary)
+    {
+        table_id table = handles.is_end(handle) ? handles.end_table(handle) : handles.get(handle).first;
+        auto &keys = by_key[table];
+        auto it = keys.end();
+        if (!handles.is_end(handle))
+        {
+            auto id = handles.get(handle).second;
+            it = keys.find(std::make_pair(by_primary[table].at(id).first, id));
+        }
+        if (it == keys.begin())
+            return -1;
+        --it;
+        *primary = it->second;
+        return handles.add(table, it->second);
+    }
+};
+
+class mock_chain
+{
+public:
+    uint64_t receiver = 0;
+    uint64_t now = 1600000000000000ull;
+    std::vector<char> transaction;
+    std::vector<char> action_data;
+    chain_counters counters;
+
+    primary_store primary;
+    secondary_store<uint64_t> idx64;
+    secondary_store<uint128_t> idx128;
+    secondary_store<key256> idx256;
+
+    struct snapshot
+    {
+        std::map<table_id, std::map<uint64_t, primary_row>> primary;
+        std::map<table_id, std::set<std::pair<uint64_t, uint64_t>>> idx64_keys;
+        std::map<table_id, std::map<uint64_t, std::pair<uint64_t, uint64_t>>> idx64_rows;
+        std::map<table_id, std::set<std::pair<uint128_t, uint64_t>>> idx128_keys;
+        std::map<table_id, std::map<uint64_t, std::pair<uint128_t, uint64_t>>> idx128_rows;
+        std::map<table_id, std::set<std::pair<key256, uint64_t>>> idx256_keys;
+        std::map<table_id, std::map<uint64_t, std::pair<key256, uint64_t>>> idx256_rows;
+        uint64_t now;
+    };
+
+    snapshot save() const
+    {
+        return snapshot{primary.tables, idx64.by_key, idx64.by_primary, idx128.by_key, idx128.by_primary,
+                        idx256.by_key, idx256.by_primary, now};
+    }
+
+    void restore(const snapshot &state)
+    {
+        primary.tables = state.primary;
+        idx64.by_key = state.idx64_keys;
+        idx64.by_primary = state.idx64_rows;
+        idx128.by_key = state.idx128_keys;
+        idx128.by_primary = state.idx128_rows;
+        idx256.by_key = state.idx256_keys;
+        idx256.by_primary = state.idx256_rows;
+        now = state.now;
+        reset_handles();
+    }
+
+    void reset_handles()
+    {
+        primary.handles.clear();
+        idx64.handles.clear();
+        idx128.handles.clear();
+        idx256.handles.clear();
+    }
+
+    void reset_counters()
+    {
+        counters = chain_counters{};
+    }
+
+    table_id own(const uint64_t &scope, const uint64_t &table) const
+    {
+        return table_id{receiver, scope, table};
+    }
+
+    static mock_chain &get()
+    {
+        static mock_chain chain;
+        return chain;
+    }
+
+    void install();
+};
+
+inline key256 to_key256(const uint128_t *data, const uint32_t &len)
+{
+    eosio::check(len == 2, "mock_chain : invalid idx256 key size");
+    return key256{data[0], data[1]};
+}
+
+inline void from_key256(const key256 &key, uint128_t *data)
+{
+    data[0] = key[0];
+    data[1] = key[1];
+}
+
+inline void mock_chain::install()
+{
+    auto &c = *this;
+
+    intrinsics::set_intrinsic<intrinsics::eosio_assert>([](uint32_t test, const char *msg) {
+        if (!test)
+            throw std::runtime_error(msg);
+    });
+    intrinsics::set_intrinsic<intrinsics::eosio_assert_message>([](uint32_t test, const char *msg, uint32_t len) {
+        if (!test)
+            throw std::runtime_error(std::string(msg, len));
+    });
+    intrinsics::set_intrinsic<intrinsics::eosio_assert_code>([](uint32_t test, uint64_t code) {
+        if (!test)
+            throw std::runtime_error("eosio_assert_code : " + std::to_string(code));
+    });
+
+    intrinsics::set_intrinsic<intrinsics::current_time>([&c]() { return c.now; });
+    intrinsics::set_intrinsic<intrinsics::current_receiver>([&c]() { return c.receiver; });
+    intrinsics::set_intrinsic<intrinsics::require_auth>([](uint64_t) {});
+    intrinsics::set_intrinsic<intrinsics::require_auth2>([](uint64_t, uint64_t) {});
+    intrinsics::set_intrinsic<intrinsics::has_auth>([](uint64_t) { return true; });
+    intrinsics::set_intrinsic<intrinsics::require_recipient>([](uint64_t) {});
+    intrinsics::set_intrinsic<intrinsics::is_account>([](uint64_t) { return true; });
+
+    //Contract console goes to stderr, apart from the benchmark report
+    intrinsics::set_intrinsic<intrinsics::prints>([](const char *str) { fputs(str, stderr); });
+    intrinsics::set_intrinsic<intrinsics::prints_l>([](const char *str, uint32_t len) { fwrite(str, 1, len, stderr); });
+    intrinsics::set_intrinsic<intrinsics::printi>([](int64_t value) { fprintf(stderr, "%lld", (long long)value); });
+    intrinsics::set_intrinsic<intrinsics::printui>([](uint64_t value) { fprintf(stderr, "%llu", (unsigned long long)value); });
+
+    intrinsics::set_intrinsic<intrinsics::transaction_size>([&c]() { return c.transaction.size(); });
+    intrinsics::set_intrinsic<intrinsics::read_transaction>([&c](char *buffer, size_t size) {
+        auto copy_size = std::min(size, c.transaction.size());
+        memcpy(buffer, c.transaction.data(), copy_size);
+        return copy_size;
+    });
+
+    intrinsics::set_intrinsic<intrinsics::action_data_size>([&c]() { return (uint32_t)c.action_data.size(); });
+    intrinsics::set_intrinsic<intrinsics::read_action_data>([&c](void *buffer, uint32_t size) {
+        auto copy_size = std::min<size_t>(size, c.action_data.size());
+        memcpy(buffer, c.action_data.data(), copy_size);
+        return (int32_t)copy_size;
+    });
+
+    intrinsics::set_intrinsic<intrinsics::send_inline>([&c](char *serialized_action, size_t size) {
+        eosio::check(size >= 2 * sizeof(uint64_t), "mock_chain : invalid inline action");
+        uint64_t action_name;
+        memcpy(&action_name, serialized_action + sizeof(uint64_t), sizeof(uint64_t));
+        ++c.counters.inline_actions;
+        ++c.counters.inline_by_action[action_name];
+    });
+
+    //Not a cryptographic hash, only stable and well mixed enough to key the bypair index.
+    intrinsics::set_intrinsic<intrinsics::sha256>([](const char *data, uint32_t length, capi_checksum256 *hash) {
+        uint64_t state[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x100000001b3ull, 0x9e3779b97f4a7c15ull};
+        for (uint32_t i = 0; i < length; ++i)
+            for (auto &s : state)
+                s = (s ^ (uint8_t)data[i]) * 0x100000001b3ull + (s >> 29);
+        memcpy(hash->hash, state, sizeof(state));
+    });
+
+    intrinsics::set_intrinsic<intrinsics::db_store_i64>([&c](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const void *data, uint32_t len) {
+        ++c.counters.db_writes;
+        return c.primary.store(c.own(scope, table), payer, id, data, len);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_update_i64>([&c](int32_t iterator, uint64_t payer, const void *data, uint32_t len) {
+        ++c.counters.db_writes;
+        c.primary.row(iterator) = primary_row{payer, std::vector<char>((const char *)data, (const char *)data + len)};
+    });
+    intrinsics::set_intrinsic<intrinsics::db_remove_i64>([&c](int32_t iterator) {
+        ++c.counters.db_writes;
+        c.primary.remove(iterator);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_get_i64>([&c](int32_t iterator, const void *data, uint32_t len) {
+        ++c.counters.db_reads;
+        const auto &value = c.primary.row(iterator).data;
+        if (len == 0)
+            return (int32_t)value.size();
+        auto copy_size = std::min<uint32_t>(len, value.size());
+        memcpy((void *)data, value.data(), copy_size);
+        return (int32_t)copy_size;
+    });
+    intrinsics::set_intrinsic<intrinsics::db_next_i64>([&c](int32_t iterator, uint64_t *primary) {
+        ++c.counters.db_reads;
+        return c.primary.next(iterator, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_previous_i64>([&c](int32_t iterator, uint64_t *primary) {
+        ++c.counters.db_reads;
+        return c.primary.previous(iterator, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_find_i64>([&c](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) {
+        ++c.counters.db_reads;
+        return c.primary.find(table_id{code, scope, table}, id);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_lowerbound_i64>([&c](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) {
+        ++c.counters.db_reads;
+        return c.primary.lowerbound(table_id{code, scope, table}, id);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_upperbound_i64>([&c](uint64_t code, uint64_t scope, uint64_t table, uint64_t id) {
+        ++c.counters.db_reads;
+        return c.primary.upperbound(table_id{code, scope, table}, id);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_end_i64>([&c](uint64_t code, uint64_t scope, uint64_t table) {
+        ++c.counters.db_reads;
+        return c.primary.end(table_id{code, scope, table});
+    });
+
+#define MOCK_SECONDARY_INDEX(IDX, STORE, KEY_T)                                                                                            \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_store>([&c](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const KEY_T *secondary) { \
+        ++c.counters.db_writes;                                                                                                            \
+        return c.STORE.store(c.own(scope, table), payer, id, *secondary);                                                                 \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_update>([&c](int32_t iterator, uint64_t payer, const KEY_T *secondary) {             \
+        ++c.counters.db_writes;                                                                                                            \
+        c.STORE.update(iterator, payer, *secondary);                                                                                       \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_remove>([&c](int32_t iterator) {                                                     \
+        ++c.counters.db_writes;                                                                                                            \
+        c.STORE.remove(iterator);                                                                                                          \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_find_primary>([&c](uint64_t code, uint64_t scope, uint64_t table, KEY_T *secondary, uint64_t primary) { \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.find_primary(table_id{code, scope, table}, secondary, primary);                                                     \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_find_secondary>([&c](uint64_t code, uint64_t scope, uint64_t table, const KEY_T *secondary, uint64_t *primary) { \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.find_secondary(table_id{code, scope, table}, *secondary, primary);                                                  \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_lowerbound>([&c](uint64_t code, uint64_t scope, uint64_t table, KEY_T *secondary, uint64_t *primary) { \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.lowerbound(table_id{code, scope, table}, secondary, primary);                                                       \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_upperbound>([&c](uint64_t code, uint64_t scope, uint64_t table, KEY_T *secondary, uint64_t *primary) { \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.upperbound(table_id{code, scope, table}, secondary, primary);                                                       \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_end>([&c](uint64_t code, uint64_t scope, uint64_t table) {                           \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.end(table_id{code, scope, table});                                                                                  \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_next>([&c](int32_t iterator, uint64_t *primary) {                                    \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.next(iterator, primary);                                                                                            \
+    });                                                                                                                                    \
+    intrinsics::set_intrinsic<intrinsics::db_##IDX##_previous>([&c](int32_t iterator, uint64_t *primary) {                                \
+        ++c.counters.db_reads;                                                                                                             \
+        return c.STORE.previous(iterator, primary);                                                                                        \
+    });
+
+    MOCK_SECONDARY_INDEX(idx64, idx64, uint64_t)
+    MOCK_SECONDARY_INDEX(idx128, idx128, uint128_t)
+#undef MOCK_SECONDARY_INDEX
+
+    intrinsics::set_intrinsic<intrinsics::db_idx256_store>([&c](uint64_t scope, uint64_t table, uint64_t payer, uint64_t id, const uint128_t *data, uint32_t len) {
+        ++c.counters.db_writes;
+        return c.idx256.store(c.own(scope, table), payer, id, to_key256(data, len));
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_update>([&c](int32_t iterator, uint64_t payer, const uint128_t *data, uint32_t len) {
+        ++c.counters.db_writes;
+        c.idx256.update(iterator, payer, to_key256(data, len));
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_remove>([&c](int32_t iterator) {
+        ++c.counters.db_writes;
+        c.idx256.remove(iterator);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_find_primary>([&c](uint64_t code, uint64_t scope, uint64_t table, uint128_t *data, uint32_t len, uint64_t primary) {
+        ++c.counters.db_reads;
+        key256 key = to_key256(data, len);
+        auto result = c.idx256.find_primary(table_id{code, scope, table}, &key, primary);
+        from_key256(key, data);
+        return result;
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_find_secondary>([&c](uint64_t code, uint64_t scope, uint64_t table, const uint128_t *data, uint32_t len, uint64_t *primary) {
+        ++c.counters.db_reads;
+        return c.idx256.find_secondary(table_id{code, scope, table}, to_key256(data, len), primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_lowerbound>([&c](uint64_t code, uint64_t scope, uint64_t table, uint128_t *data, uint32_t len, uint64_t *primary) {
+        ++c.counters.db_reads;
+        key256 key = to_key256(data, len);
+        auto result = c.idx256.lowerbound(table_id{code, scope, table}, &key, primary);
+        from_key256(key, data);
+        return result;
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_upperbound>([&c](uint64_t code, uint64_t scope, uint64_t table, uint128_t *data, uint32_t len, uint64_t *primary) {
+        ++c.counters.db_reads;
+        key256 key = to_key256(data, len);
+        auto result = c.idx256.upperbound(table_id{code, scope, table}, &key, primary);
+        from_key256(key, data);
+        return result;
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_end>([&c](uint64_t code, uint64_t scope, uint64_t table) {
+        ++c.counters.db_reads;
+        return c.idx256.end(table_id{code, scope, table});
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_next>([&c](int32_t iterator, uint64_t *primary) {
+        ++c.counters.db_reads;
+        return c.idx256.next(iterator, primary);
+    });
+    intrinsics::set_intrinsic<intrinsics::db_idx256_previous>([&c](int32_t iterator, uint64_t *primary) {
+        ++c.counters.db_reads;
+        return c.idx256.previous(iterator, primary);
+    });
+}
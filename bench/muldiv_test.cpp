@@ -0,0 +1,213 @@
+#include "mock_chain.hpp"
+#include "muldiv.hpp"
+#include "resourses.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <random>
+
+//Host-side checks of the integer muldiv against the double formulas it replaced in count_share, the swap back
+//rate, the pool price, the package price in validation_income_amount and the redemption sum.
+//Every result must be the exactly rounded quotient of a * b / c. Where the double formula had a single rounding
+//step and an exact product below 2^53 both must agree, otherwise they may differ by the double rounding error.
+
+struct formula
+{
+    std::string name;
+    bool ceil;
+    bool single_rounding;
+    std::function<int64_t(int64_t, int64_t, int64_t)> current;
+    std::function<double(int64_t, int64_t, int64_t)> legacy;
+};
+
+struct formula_stats
+{
+    uint64_t cases = 0;
+    uint64_t differs = 0;
+    uint64_t legacy_overflows = 0;
+    uint64_t overflows = 0;
+    uint64_t failed = 0;
+};
+
+const double two_pow_53 = 9007199254740992.0;
+const double two_pow_63 = 9223372036854775808.0;
+
+__int128 abs128(const __int128 &value) { return value < 0 ? -value : value; }
+
+//Truncation toward zero or ceiling of a * b / c, checked by its defining inequalities rather than by division
+bool is_exact_quotient(const int64_t &q, const int64_t &a, const int64_t &b, const int64_t &c, const bool &ceil)
+{
+    __int128 product = (__int128)a * b;
+    __int128 scaled = (__int128)q * c;
+    if (ceil)
+        return scaled >= product && scaled - product < c;
+
+    bool same_sign = q == 0 || ((q > 0) == ((product > 0) == (c > 0)));
+    return same_sign && abs128(scaled) <= abs128(product) && abs128(product) - abs128(scaled) < abs128((__int128)c);
+}
+
+bool overflows(const int64_t &a, const int64_t &b, const int64_t &c, const bool &ceil)
+{
+    __int128 product = (__int128)a * b;
+    __int128 q = product / c;
+    if (ceil && product % c != 0 && (product > 0) == (c > 0))
+        ++q;
+    return q > INT64_MAX || q < INT64_MIN;
+}
+
+void check_case(const formula &f, formula_stats &stats, const int64_t &a, const int64_t &b, const int64_t &c)
+{
+    ++stats.cases;
+    if (overflows(a, b, c, f.ceil))
+    {
+        ++stats.overflows;
+        try
+        {
+            f.current(a, b, c);
+            fprintf(stderr, "%s(%lld, %lld, %lld): overflow is not reported\n", f.name.c_str(), (long long)a, (long long)b, (long long)c);
+            ++stats.failed;
+        }
+        catch (const std::exception &)
+        {
+        }
+        return;
+    }
+
+    int64_t current = f.current(a, b, c);
+    if (!is_exact_quotient(current, a, b, c, f.ceil))
+    {
+        fprintf(stderr, "%s(%lld, %lld, %lld) = %lld is not exact\n", f.name.c_str(), (long long)a, (long long)b, (long long)c, (long long)current);
+        ++stats.failed;
+        return;
+    }
+
+    double legacy = f.legacy(a, b, c);
+    if (!(std::fabs(legacy) < two_pow_63))
+    {
+        ++stats.legacy_overflows;
+        return;
+    }
+
+    int64_t legacy_amount = (int64_t)legacy;
+    if (legacy_amount == current)
+        return;
+    ++stats.differs;
+
+    bool exact_legacy = f.single_rounding && std::fabs((double)a * (double)b) < two_pow_53;
+    double tolerance = exact_legacy ? 0 : 1 + std::fabs((double)current) * std::ldexp(1.0, -50);
+    if (std::fabs((double)legacy_amount - (double)current) > tolerance)
+    {
+        fprintf(stderr, "%s(%lld, %lld, %lld) = %lld, double formula gave %lld\n", f.name.c_str(), (long long)a, (long long)b,
+                (long long)c, (long long)current, (long long)legacy_amount);
+        ++stats.failed;
+    }
+}
+
+std::vector<int64_t> boundary_values()
+{
+    std::vector<int64_t> result = {1, 2, 3, 7, 9, 10, 11, 999, 1000, 1001, 9999, 10000, 10001, 99999, 100000, 100001,
+                                   99999999, 100000000, 100000001, 1000000000000, (1ll << 53) - 1, 1ll << 53, (1ll << 53) + 1,
+                                   INT64_MAX / 1000, INT64_MAX / 10, INT64_MAX - 1, INT64_MAX};
+
+    std::mt19937_64 rng(7);
+    for (int shift = 4; shift < 63; shift += 3)
+        result.push_back(1 + rng() % (1ull << shift));
+    return result;
+}
+
+std::vector<formula> make_formulas()
+{
+    return {
+        {"count_share", false, true,
+         [](int64_t quantity, int64_t share, int64_t max) { return mul_div(quantity, share, max); },
+         [](int64_t quantity, int64_t share, int64_t max) { return (double)quantity * (double)share / (double)max; }},
+        {"swap_back rate", false, false,
+         [](int64_t amount, int64_t cash, int64_t token_out) { return price_ratio{cash, token_out}.apply(amount); },
+         [](int64_t amount, int64_t cash, int64_t token_out) { return amount / ((double)token_out / cash); }},
+        {"pool_price", false, false,
+         [](int64_t amount, int64_t token2, int64_t token1) { return price_ratio{token2, token1}.apply(amount); },
+         [](int64_t amount, int64_t token2, int64_t token1) { return amount * ((double)token2 / (double)token1); }},
+        {"validation_income_amount ceil", true, false,
+         [](int64_t package, int64_t token2, int64_t token1) { return price_ratio{token2, token1}.apply_ceil(package); },
+         [](int64_t package, int64_t token2, int64_t token1) { return std::ceil(package * ((double)token2 / (double)token1)); }},
+        {"redemption sum", false, false,
+         [](int64_t quantity, int64_t package, int64_t cash) { return mul_div(quantity, package, cash); },
+         [](int64_t quantity, int64_t package, int64_t cash) { return (double)quantity / cash * package; }},
+    };
+}
+
+int main()
+{
+    mock_chain::get().install();
+
+    const auto values = boundary_values();
+    std::vector<int64_t> shares;
+    for (int64_t share = 0; share <= max_percent.amount; share += 7)
+        shares.push_back(share);
+    shares.push_back(max_percent.amount);
+
+    int failed = 0;
+    for (const auto &f : make_formulas())
+    {
+        formula_stats stats;
+        for (auto a : values)
+        {
+            for (auto sign : {1, -1})
+            {
+                if (f.name == "count_share")
+                {
+                    for (auto share : shares)
+                        check_case(f, stats, sign * a, share, max_percent.amount);
+                }
+                else if (f.name == "redemption sum")
+                {
+                    for (auto cash : values)
+                        check_case(f, stats, sign * a, usdcash_package_amount, cash);
+                }
+                else
+                {
+                    for (auto b : values)
+                    {
+                        std::vector<int64_t> divisors = {b - 1, b, 3, 10000, 100000000, INT64_MAX};
+                        if (b < INT64_MAX)
+                            divisors.push_back(b + 1);
+                        for (auto c : divisors)
+                            if (c > 0)
+                                check_case(f, stats, sign * a, b, c);
+                    }
+                }
+            }
+        }
+
+        printf("%-32s %10llu cases %8llu differ from double %8llu double overflows %8llu reported overflows %4llu failed\n",
+               f.name.c_str(), (unsigned long long)stats.cases, (unsigned long long)stats.differs,
+               (unsigned long long)stats.legacy_overflows, (unsigned long long)stats.overflows, (unsigned long long)stats.failed);
+        failed += stats.failed;
+    }
+
+    //Spot checks of the values the contract relies on
+    auto expect = [&](bool ok, const char *what) {
+        if (!ok)
+        {
+            fprintf(stderr, "%s\n", what);
+            ++failed;
+        }
+    };
+    expect(mul_div(INT64_MAX, max_percent.amount, max_percent.amount) == INT64_MAX, "count_share of INT64_MAX at 100%");
+    expect(mul_div(-7, 3, 2) == -10, "negative amounts are truncated toward zero");
+    expect(mul_div_ceil(-7, 3, 2) == -10, "negative ceil rounds toward positive infinity");
+    expect(price_ratio{1000000000000, 100000000}.apply_ceil(10000) == 100000000, "package price of the bench pool");
+    expect(mul_div(1000000000, usdcash_package_amount, 100000) == 100000000000, "redemption sum of one bench redemption");
+
+    try
+    {
+        mul_div(1, 1, 0);
+        expect(false, "division by zero is not reported");
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    printf("%s\n", failed == 0 ? "muldiv: all checks passed" : "muldiv: FAILED");
+    return failed == 0 ? 0 : 1;
+}
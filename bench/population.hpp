@@ -0,0 +1,122 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <string>
+
+//Synthetic token.pc state for the scaling benchmarks: holders with lognormal balances, inheritance rows
+//with one to three inheritors, a royalty holder set and deposits whose MLNK price drifts as a random walk.
+//Expects the token, swap income and pool to be seeded already.
+
+struct population_config
+{
+    uint32_t accounts;
+    uint32_t deposits;
+    uint64_t seed = 42;
+};
+
+//Bump when generate_population changes, so stored images of the old population are regenerated
+const uint32_t population_version = 2;
+
+inline std::string population_key(const population_config &config)
+{
+    return "population_v" + std::to_string(population_version) + "_" + std::to_string(config.accounts) + "_" +
+           std::to_string(config.deposits) + "_" + std::to_string(config.seed);
+}
+
+inline name population_name(uint64_t i)
+{
+    std::string str = "pop";
+    for (int k = 0; k < 6; ++k, i /= 26)
+        str += char('a' + i % 26);
+    return name(str);
+}
+
+inline void generate_population(const name &self, const population_config &config)
+{
+    auto &chain = mock_chain::get();
+    auto previous = chain.receiver;
+    chain.receiver = self.value;
+
+    std::mt19937_64 rng(config.seed);
+    std::lognormal_distribution<double> balance_dist(std::log(1e9), 2.0);
+    std::geometric_distribution<int64_t> lots_dist(0.3);
+    std::normal_distribution<double> price_step(0.0, 0.002);
+    std::uniform_int_distribution<uint32_t> inheritors_dist(1, 3);
+
+    const uint32_t now = chain.now / 1000000;
+    const int64_t min_balance = 100000;
+    int64_t supply = 0;
+
+    inheritance _inheritance(self, self.value);
+    for (uint32_t i = 0; i < config.accounts; ++i)
+    {
+        auto user = population_name(i);
+        auto amount = std::max<int64_t>(min_balance, balance_dist(rng));
+        supply += amount;
+
+        accounts _accounts(self, user.value);
+        _accounts.emplace(self, [&](auto &a) {
+            a.balance = asset(amount, USDCASH);
+        });
+
+        std::vector<inheritor_record> inheritors;
+        uint32_t count = std::min(inheritors_dist(rng), config.accounts > 1 ? config.accounts - 1 : 0);
+        int64_t rest = max_percent.amount;
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            int64_t share = k + 1 == count ? rest : max_percent.amount / count;
+            inheritors.push_back({population_name((i + k + 1) % config.accounts), asset(share, inh_percent)});
+            rest -= share;
+        }
+
+        _inheritance.emplace(self, [&](auto &m) {
+            m.user_name = user;
+            m.inheritance_date = time_point_sec(now + rng() % initial_period);
+            m.inactive_period = initial_period;
+            m.inheritors = inheritors;
+        });
+    }
+
+    stats _stats(self, USDCASH.code().raw());
+    _stats.modify(_stats.get(USDCASH.code().raw()), same_payer, [&](auto &s) {
+        s.supply += asset(supply, USDCASH);
+    });
+
+    royalties _royalties(self, self.value);
+    uint32_t holders = std::min<uint32_t>(max_percent.amount, config.accounts / 100 + 1);
+    for (uint32_t i = 0; i < holders; ++i)
+    {
+        _royalties.emplace(self, [&](auto &r) {
+            royalty_holder temp(time_point_sec(now), population_name(i), asset(1, inh_percent));
+            temp.set_checkpoint(0, 0);
+            r = temp;
+        });
+    }
+    royalty_sums(self, self.value).set(royalty_sum{asset(holders, inh_percent)}, self);
+
+    deposits _deposits(self, self.value);
+    double price = 1.0;
+    for (uint32_t j = 0; j < config.deposits; ++j)
+    {
+        price *= std::exp(price_step(rng));
+        int64_t lots = 100 * (1 + lots_dist(rng));
+        int64_t package_mlnk = std::llround(1e8 * price);
+
+        _deposits.emplace(self, [&](auto &d) {
+            d.id = j;
+            d.owner = population_name(rng() % config.accounts);
+            d.mlnk_amount = lots * package_mlnk;
+            d.usdt_amount = lots * 10000;
+            d.cash_amount = d.usdt_amount * 10;
+            d.creation_date = time_point_sec(now - config.deposits + j);
+        });
+    }
+
+    redemption_book book(self);
+    for (const auto &d : _deposits)
+        book.insert(d);
+    book.save();
+
+    chain.receiver = previous;
+    chain.reset_handles();
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include "mock_chain.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Binary image of the mock chain state, so large populations are generated once and reloaded from a
+//memory-mapped file. Secondary key sets are rebuilt from the per-row entries on load.
+//The header carries the format version and a key describing how the state was made, an image that
+//does not match both is treated as missing and generated again. Bump the version when the image
+//layout or the layout of the stored contract rows changes.
+
+const uint64_t state_image_magic = 0x31474d49435054ull; //"TPCIMG1"
+const uint32_t state_image_version = 2;
+
+class image_writer
+{
+private:
+    FILE *file;
+
+public:
+    explicit image_writer(const std::string &path) : file(fopen(path.c_str(), "wb"))
+    {
+        eosio::check(file != nullptr, "state_image : can not create image");
+    }
+
+    ~image_writer() { fclose(file); }
+
+    void write(const void *data, const size_t &size)
+    {
+        eosio::check(fwrite(data, 1, size, file) == size, "state_image : write failed");
+    }
+
+    template <typename T>
+    void write(const T &value) { write(&value, sizeof(T)); }
+};
+
+class image_reader
+{
+private:
+    const char *begin = nullptr;
+    const char *pos = nullptr;
+    size_t size = 0;
+
+public:
+    explicit image_reader(const std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        eosio::check(fd >= 0, "state_image : can not open image");
+        struct stat info;
+        fstat(fd, &info);
+        size = info.st_size;
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        eosio::check(mapped != MAP_FAILED, "state_image : mmap failed");
+        begin = pos = static_cast<const char *>(mapped);
+    }
+
+    ~image_reader() { munmap(const_cast<char *>(begin), size); }
+
+    const char *read(const size_t &length)
+    {
+        eosio::check(pos + length <= begin + size, "state_image : image is truncated");
+        auto result = pos;
+        pos += length;
+        return result;
+    }
+
+    template <typename T>
+    T read()
+    {
+        T value;
+        memcpy(&value, read(sizeof(T)), sizeof(T));
+        return value;
+    }
+};
+
+template <typename K>
+void write_secondary(image_writer &out, const secondary_store<K> &store)
+{
+    out.write<uint64_t>(store.by_primary.size());
+    for (const auto &[table, rows] : store.by_primary)
+    {
+        out.write(table);
+        out.write<uint64_t>(rows.size());
+        for (const auto &[id, entry] : rows)
+        {
+            out.write(id);
+            out.write(entry.first);
+            out.write(entry.second);
+        }
+    }
+}
+
+template <typename K>
+void read_secondary(image_reader &in, secondary_store<K> &store)
+{
+    store.by_key.clear();
+    store.by_primary.clear();
+    auto tables = in.read<uint64_t>();
+    for (uint64_t t = 0; t < tables; ++t)
+    {
+        auto table = in.read<table_id>();
+        auto &keys = store.by_key[table];
+        auto &rows = store.by_primary[table];
+        auto count = in.read<uint64_t>();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            auto id = in.read<uint64_t>();
+            auto key = in.read<K>();
+            auto payer = in.read<uint64_t>();
+            keys.emplace_hint(keys.end(), key, id);
+            rows.emplace_hint(rows.end(), id, std::make_pair(key, payer));
+        }
+    }
+}
+
+inline void save_state_image(const mock_chain &chain, const std::string &path, const std::string &key)
+{
+    image_writer out(path);
+    out.write(state_image_magic);
+    out.write(state_image_version);
+    out.write<uint32_t>(key.size());
+    out.write(key.data(), key.size());
+    out.write(chain.now);
+
+    out.write<uint64_t>(chain.primary.tables.size());
+    for (const auto &[table, rows] : chain.primary.tables)
+    {
+        out.write(table);
+        out.write<uint64_t>(rows.size());
+        for (const auto &[id, row] : rows)
+        {
+            out.write(id);
+            out.write(row.payer);
+            out.write<uint32_t>(row.data.size());
+            out.write(row.data.data(), row.data.size());
+        }
+    }
+
+    write_secondary(out, chain.idx64);
+    write_secondary(out, chain.idx128);
+    write_secondary(out, chain.idx256);
+}
+
+inline bool load_state_image(mock_chain &chain, const std::string &path, const std::string &key)
+{
+    if (access(path.c_str(), R_OK) != 0)
+        return false;
+
+    image_reader in(path);
+    if (in.read<uint64_t>() != state_image_magic || in.read<uint32_t>() != state_image_version)
+        return false;
+    auto length = in.read<uint32_t>();
+    if (std::string(in.read(length), length) != key)
+        return false;
+
+    chain.now = in.read<uint64_t>();
+
+    chain.primary.tables.clear();
+    auto tables = in.read<uint64_t>();
+    for (uint64_t t = 0; t < tables; ++t)
+    {
+        auto &rows = chain.primary.tables[in.read<table_id>()];
+        auto count = in.read<uint64_t>();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            auto id = in.read<uint64_t>();
+            auto payer = in.read<uint64_t>();
+            auto length = in.read<uint32_t>();
+            auto data = in.read(length);
+            rows.emplace_hint(rows.end(), id, primary_row{payer, std::vector<char>(data, data + length)});
+        }
+    }
+
+    read_secondary(in, chain.idx64);
+    read_secondary(in, chain.idx128);
+    read_secondary(in, chain.idx256);
+    chain.reset_handles();
+    return true;
+}
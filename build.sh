@@ -8,6 +8,8 @@ function usage() {
   -d          Debug build type.
   -p          Preprod accounts.
   -t          Build unit tests.
+  -b          Build native benchmarks.
+  -i          Instrumented build with performance counters.
   -y          Noninteractive mode (Uses defaults for each prompt.)
   -h          Print this help menu.
    \\n" "$0" 1>&2
@@ -16,10 +18,12 @@ function usage() {
 
 CMAKE_BUILD_TYPE=Release
 BUILD_TESTS=false
+BUILD_BENCH=false
+PERF_COUNTERS=false
 PREPROD=false
 
 if [ $# -ne 0 ]; then
-  while getopts "e:c:dptyh" opt; do
+  while getopts "e:c:dptbiyh" opt; do
     case "${opt}" in
       e )
         EOSIO_DIR_PROMPT=$OPTARG
@@ -36,6 +40,12 @@ if [ $# -ne 0 ]; then
       t )
         BUILD_TESTS=true
       ;;
+      b )
+        BUILD_BENCH=true
+      ;;
+      i )
+        PERF_COUNTERS=true
+      ;;
       y )
         NONINTERACTIVE=true
         PROCEED=true
@@ -89,6 +99,6 @@ NC='\033[0m'
 CPU_CORES=$(getconf _NPROCESSORS_ONLN)
 mkdir -p build
 pushd build &> /dev/null
-cmake -DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE} -DBUILD_TESTS=${BUILD_TESTS} -DPREPROD=${PREPROD} ../
+cmake -DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE} -DBUILD_TESTS=${BUILD_TESTS} -DBUILD_BENCH=${BUILD_BENCH} -DPREPROD=${PREPROD} -DPERF_COUNTERS=${PERF_COUNTERS} ../
 make -j $CPU_CORES
 popd &> /dev/null
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Plot the CSV of `token.pc.bench --scale` as time against table size per action.
+
+Usage: plot_scaling.py SCALING_CSV [--out scaling.png] [--metric ns|db_reads|db_writes|inline]
+
+Without matplotlib it prints the same curves as a table.
+"""
+import argparse
+import collections
+import csv
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("csv")
+    parser.add_argument("--out", default="scaling.png")
+    parser.add_argument("--metric", choices=["ns", "db_reads", "db_writes", "inline"], default="ns")
+    args = parser.parse_args()
+
+    curves = collections.defaultdict(list)
+    with open(args.csv) as data:
+        for row in csv.DictReader(data):
+            curves[row["scenario"]].append((int(row["rows"]), float(row[args.metric])))
+
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        sizes = sorted({rows for points in curves.values() for rows, _ in points})
+        print("{:<28}".format("scenario") + "".join("{:>14}".format(s) for s in sizes))
+        for scenario, points in sorted(curves.items()):
+            values = dict(points)
+            print("{:<28}".format(scenario) + "".join("{:>14.0f}".format(values[s]) if s in values else "{:>14}".format("-") for s in sizes))
+        return
+
+    figure, axes = plt.subplots(figsize=(9, 6))
+    for scenario, points in sorted(curves.items()):
+        points.sort()
+        axes.plot([p[0] for p in points], [p[1] for p in points], marker="o", label=scenario)
+    axes.set_xscale("log")
+    axes.set_yscale("log")
+    axes.set_xlabel("rows per table")
+    axes.set_ylabel(args.metric + " per action")
+    axes.grid(True, which="both", alpha=0.3)
+    axes.legend()
+    figure.savefig(args.out, dpi=120, bbox_inches="tight")
+    print("written {}".format(args.out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Fold token.pc probe records from a nodeos --contracts-console log.
+
+Usage: probe_report.py LOG [--collapsed FILE] [--weight time|calls]
+
+Prints per-helper calls, inclusive and exclusive cost. With --collapsed it also
+writes collapsed stacks (one "frame;frame;frame weight" line per stack) that
+flamegraph.pl and speedscope read directly.
+"""
+import argparse
+import collections
+import re
+import sys
+
+BEGIN = re.compile(r"\[\((?P<code>[^,]+),(?P<action>[^)]+)\)->(?P<receiver>[^\]]+)\]: CONSOLE OUTPUT BEGIN")
+END = re.compile(r"\]: CONSOLE OUTPUT END")
+RECORD = re.compile(r"@(?P<dir>[<>])(?P<label>\S+) (?P<time>\d+)")
+
+
+class Stats:
+    def __init__(self):
+        self.calls = 0
+        self.inclusive = 0
+        self.exclusive = 0
+
+
+def fold(lines):
+    stats = collections.defaultdict(Stats)
+    stacks = collections.Counter()
+    stack_calls = collections.Counter()
+    root = "native"
+    frames = []
+    broken = 0
+
+    for line in lines:
+        begin = BEGIN.search(line)
+        if begin:
+            root = "{}::{}".format(begin.group("code"), begin.group("action"))
+            broken += len(frames)
+            frames = []
+            continue
+        if END.search(line):
+            broken += len(frames)
+            frames = []
+            continue
+
+        for record in RECORD.finditer(line):
+            label, time = record.group("label"), int(record.group("time"))
+            if record.group("dir") == ">":
+                frames.append([label, time, 0])
+                continue
+
+            if not frames or frames[-1][0] != label:
+                broken += 1
+                frames = []
+                continue
+
+            _, start, children = frames.pop()
+            inclusive = time - start
+            exclusive = inclusive - children
+            if frames:
+                frames[-1][2] += inclusive
+
+            path = ";".join([root] + [f[0] for f in frames] + [label])
+            stats[label].calls += 1
+            stats[label].inclusive += inclusive
+            stats[label].exclusive += exclusive
+            stacks[path] += exclusive
+            stack_calls[path] += 1
+
+    return stats, stacks, stack_calls, broken
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log")
+    parser.add_argument("--collapsed", help="write collapsed stacks to this file")
+    parser.add_argument("--weight", choices=["time", "calls"], default="time",
+                        help="collapsed stack weight, on chain probes only see block time so use calls there")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") as log:
+        stats, stacks, stack_calls, broken = fold(log)
+
+    print("{:<28} {:>10} {:>16} {:>16}".format("helper", "calls", "inclusive", "exclusive"))
+    for label, s in sorted(stats.items(), key=lambda item: (-item[1].exclusive, -item[1].calls)):
+        print("{:<28} {:>10} {:>16} {:>16}".format(label, s.calls, s.inclusive, s.exclusive))
+    if broken:
+        print("{} unbalanced probe records skipped (aborted actions)".format(broken), file=sys.stderr)
+
+    if args.collapsed:
+        weights = stack_calls if args.weight == "calls" else stacks
+        with open(args.collapsed, "w") as out:
+            for path, weight in sorted(weights.items()):
+                out.write("{} {}\n".format(path, weight))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""Replay recorded token.pc actions against a fresh local nodeos and report their cost.
+
+Usage:
+  replay.py RECORDING --nodeos PATH --contract-dir build/Debug/token.pc
+            --token-dir EOSIO_TOKEN_DIR [--swap-dir SWAP_PCASH_DIR]
+            [--setup FILE] [--map mainnet=local ...] [--json OUT]
+
+RECORDING is JSON lines, one transaction per line. A line is either a single action
+or {"actions": [...]} for transactions with several actions (deposits send USDT and
+MLNK in one transaction). Actions use the history API layout:
+  {"account": "token.pc", "name": "transfer",
+   "authorization": [{"actor": "alice", "permission": "active"}],
+   "data": {"from": "alice", "to": "bob", "quantity": "1.00000 USDCASH", "memo": ""}}
+
+The local chain gets token.pc plus stand-ins for tethertether and swap.pcash.
+tethertether runs eosio.token. swap.pcash runs the swap.pcash build from --swap-dir,
+or eosio.token when it is not given, so there are no pools and deposits fail.
+Build token.pc with ./build.sh -d so it uses these local account names, and map
+mainnet names onto them with --map. Every account named in the recording is created.
+The --setup file has the same format and runs before the measured replay, e.g. to
+create and issue USDT and MLNK or to create the MLNK/USDT pool.
+
+Per action type it prints billed CPU (us), NET (bytes) and RAM delta (bytes) as
+p50/p95/max. --json writes every measurement, so two builds can be compared.
+"""
+import argparse
+import collections
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+#Well known EOSIO development key, only for the throwaway local chain
+DEV_PUBLIC_KEY = "EOS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV"
+DEV_PRIVATE_KEY = "5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3"
+
+CONTRACT = "token.pc"
+TETHER = "tethertether"
+SWAP = "swap.pcash"
+MLNK_ACCOUNT = "pcash.mlnk"
+SYSTEM_ACCOUNTS = {"eosio", "eosio.token", "eosio.null", "eosio.prods"}
+NAME = re.compile(r"^[a-z1-5.]{1,12}$")
+
+
+class Chain:
+    def __init__(self, args):
+        self.args = args
+        self.url = "http://127.0.0.1:{}".format(args.port)
+        self.data_dir = tempfile.mkdtemp(prefix="token.pc.replay.")
+        self.wallet_dir = os.path.join(self.data_dir, "wallet")
+        self.nodeos = None
+        self.keosd = None
+
+    def start(self):
+        os.makedirs(self.wallet_dir)
+        self.keosd = subprocess.Popen([self.args.keosd, "--wallet-dir", self.wallet_dir,
+                                       "--unix-socket-path", os.path.join(self.wallet_dir, "keosd.sock"),
+                                       "--http-server-address", "",
+                                       #Long replays outlast the default 900 s lock
+                                       "--unlock-timeout", "999999999"],
+                                      stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        self.nodeos = subprocess.Popen([self.args.nodeos, "-e", "-p", "eosio",
+                                        "--plugin", "eosio::chain_api_plugin",
+                                        "--plugin", "eosio::http_plugin",
+                                        "--data-dir", os.path.join(self.data_dir, "data"),
+                                        "--config-dir", os.path.join(self.data_dir, "config"),
+                                        "--http-server-address", "127.0.0.1:{}".format(self.args.port),
+                                        "--max-transaction-time", "1000",
+                                        "--contracts-console"],
+                                       stdout=subprocess.DEVNULL, stderr=open(os.path.join(self.data_dir, "nodeos.log"), "w"))
+        for _ in range(50):
+            if self.cleos(["get", "info"], check=False).returncode == 0:
+                break
+            time.sleep(0.2)
+        else:
+            sys.exit("nodeos did not start, see {}".format(os.path.join(self.data_dir, "nodeos.log")))
+
+        self.cleos(["wallet", "create", "-n", "replay", "--to-console"])
+        self.cleos(["wallet", "import", "-n", "replay", "--private-key", DEV_PRIVATE_KEY])
+
+    def stop(self):
+        for process in (self.nodeos, self.keosd):
+            if process:
+                process.terminate()
+                process.wait()
+        if not self.args.keep:
+            shutil.rmtree(self.data_dir, ignore_errors=True)
+
+    def cleos(self, arguments, check=True):
+        command = [self.args.cleos, "-u", self.url,
+                   "--wallet-url", "unix://" + os.path.join(self.wallet_dir, "keosd.sock")] + arguments
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+        if check and result.returncode != 0:
+            sys.exit("{} failed:\n{}".format(" ".join(arguments[:3]), result.stderr))
+        return result
+
+    def create_account(self, account):
+        self.cleos(["create", "account", "eosio", account, DEV_PUBLIC_KEY, DEV_PUBLIC_KEY])
+
+    def set_contract(self, account, directory):
+        wasm = [f for f in os.listdir(directory) if f.endswith(".wasm")]
+        abi = [f for f in os.listdir(directory) if f.endswith(".abi")]
+        if not wasm or not abi:
+            sys.exit("no wasm/abi in {}".format(directory))
+        self.cleos(["set", "contract", account, directory, wasm[0], abi[0]])
+        self.cleos(["set", "account", "permission", account, "active", "--add-code"])
+
+    def push(self, actions):
+        transaction = {"actions": actions}
+        return self.cleos(["push", "transaction", json.dumps(transaction), "-j", "-f"], check=False)
+
+
+def read_recording(path, mapping):
+    transactions = []
+    with open(path) as recording:
+        for line in recording:
+            line = line.strip()
+            if not line:
+                continue
+            entry = json.loads(line)
+            actions = entry["actions"] if "actions" in entry else [entry]
+            transactions.append([rename(a, mapping) for a in actions])
+    return transactions
+
+
+def rename(value, mapping):
+    if isinstance(value, dict):
+        return {k: rename(v, mapping) for k, v in value.items()}
+    if isinstance(value, list):
+        return [rename(v, mapping) for v in value]
+    if isinstance(value, str):
+        return mapping.get(value, value)
+    return value
+
+
+def accounts_of(transactions):
+    accounts = set()
+    for actions in transactions:
+        for action in actions:
+            for auth in action.get("authorization", []):
+                accounts.add(auth["actor"])
+            for key in ("from", "to", "owner", "user", "user_name", "initiator", "ram_payer", "issuer", "inheritance_owner"):
+                value = action.get("data", {}).get(key)
+                if isinstance(value, str) and NAME.match(value):
+                    accounts.add(value)
+    return accounts - SYSTEM_ACCOUNTS - {CONTRACT, TETHER, SWAP, MLNK_ACCOUNT}
+
+
+def measure(trace):
+    processed = trace["processed"]
+    ram = 0
+    for action_trace in processed.get("action_traces", []):
+        for delta in action_trace.get("account_ram_deltas", []):
+            ram += delta["delta"]
+    return {
+        "cpu": processed["receipt"]["cpu_usage_us"],
+        "net": processed["receipt"]["net_usage_words"] * 8,
+        "ram": ram,
+    }
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("recording")
+    parser.add_argument("--contract-dir", required=True, help="directory with token.pc.wasm and token.pc.abi")
+    parser.add_argument("--token-dir", required=True, help="directory with the eosio.token wasm and abi")
+    parser.add_argument("--swap-dir", help="directory with the swap.pcash wasm and abi")
+    parser.add_argument("--setup", help="actions to run before the measured replay")
+    parser.add_argument("--map", action="append", default=[], metavar="FROM=TO", help="rename an account in the recording")
+    parser.add_argument("--json", help="write every measurement to this file")
+    parser.add_argument("--nodeos", default="nodeos")
+    parser.add_argument("--keosd", default="keosd")
+    parser.add_argument("--cleos", default="cleos")
+    parser.add_argument("--port", type=int, default=8988)
+    parser.add_argument("--keep", action="store_true", help="keep the chain data directory")
+    args = parser.parse_args()
+
+    mapping = dict(m.split("=", 1) for m in args.map)
+    setup = read_recording(args.setup, mapping) if args.setup else []
+    transactions = read_recording(args.recording, mapping)
+
+    chain = Chain(args)
+    try:
+        chain.start()
+        for account in [CONTRACT, TETHER, SWAP, MLNK_ACCOUNT] + sorted(accounts_of(setup + transactions)):
+            chain.create_account(account)
+        chain.set_contract(CONTRACT, args.contract_dir)
+        chain.set_contract(TETHER, args.token_dir)
+        chain.set_contract(SWAP, args.swap_dir or args.token_dir)
+
+        for actions in setup:
+            result = chain.push(actions)
+            if result.returncode != 0:
+                sys.exit("setup transaction failed:\n{}".format(result.stderr))
+
+        results = collections.defaultdict(list)
+        failures = collections.Counter()
+        for actions in transactions:
+            kind = "+".join("{}::{}".format(a["account"], a["name"]) for a in actions)
+            result = chain.push(actions)
+            if result.returncode != 0:
+                failures[kind] += 1
+                continue
+            results[kind].append(measure(json.loads(result.stdout)))
+    finally:
+        chain.stop()
+
+    header = "{:<40} {:>6} {:>20} {:>20} {:>20}".format("action", "count", "cpu us p50/p95/max", "net B p50/p95/max", "ram B p50/p95/max")
+    print(header)
+    for kind in sorted(results):
+        row = [kind, len(results[kind])]
+        for metric in ("cpu", "net", "ram"):
+            values = [r[metric] for r in results[kind]]
+            row.append("{}/{}/{}".format(percentile(values, 0.5), percentile(values, 0.95), max(values)))
+        print("{:<40} {:>6} {:>20} {:>20} {:>20}".format(*row))
+    for kind, count in sorted(failures.items()):
+        print("{:<40} {:>6} failed".format(kind, count), file=sys.stderr)
+
+    if args.json:
+        with open(args.json, "w") as out:
+            json.dump({"results": results, "failures": failures}, out, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,3 @@
+#!/bin/bash
+set -e
+./build/Release/bench/token.pc.bench "$@"
\ No newline at end of file
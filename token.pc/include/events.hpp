@@ -0,0 +1,23 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+
+enum event_type : uint8_t
+{
+    inheritance_event = 0,
+    royalty_event = 1,
+    issue_event = 2,
+    retire_event = 3
+};
+
+struct event
+{
+    uint8_t type;
+    name to;
+    name from;
+    asset quantity;
+
+    EOSLIB_SERIALIZE(event, (type)(to)(from)(quantity))
+};
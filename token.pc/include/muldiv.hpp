@@ -0,0 +1,48 @@
+#pragma once
+#include <eosio/check.hpp>
+#include <stdint.h>
+
+//Integer replacement for double based share and rate calculations.
+//Products are kept in 128 bits, so a * b never overflows for int64 inputs.
+//Results are truncated toward zero exactly like the former asset(double) conversions.
+
+constexpr int64_t narrow_to_int64(const __int128 &value)
+{
+    if (value > INT64_MAX || value < INT64_MIN)
+        eosio::check(false, "muldiv : result overflow");
+    return (int64_t)value;
+}
+
+constexpr int64_t mul_div(const int64_t &a, const int64_t &b, const int64_t &c)
+{
+    if (c == 0)
+        eosio::check(false, "muldiv : division by zero");
+    return narrow_to_int64((__int128)a * b / c);
+}
+
+constexpr int64_t mul_div_ceil(const int64_t &a, const int64_t &b, const int64_t &c)
+{
+    if (c == 0)
+        eosio::check(false, "muldiv : division by zero");
+    __int128 product = (__int128)a * b;
+    __int128 result = product / c;
+    if (product % c != 0 && ((product > 0) == (c > 0)))
+        ++result;
+    return narrow_to_int64(result);
+}
+
+struct price_ratio
+{
+    int64_t num;
+    int64_t den;
+
+    constexpr int64_t apply(const int64_t &amount) const { return mul_div(amount, num, den); }
+    constexpr int64_t apply_ceil(const int64_t &amount) const { return mul_div_ceil(amount, num, den); }
+};
+
+static_assert(mul_div(7, 3, 2) == 10);
+static_assert(mul_div(-7, 3, 2) == -10);
+static_assert(mul_div_ceil(7, 3, 2) == 11);
+static_assert(mul_div_ceil(4, 3, 2) == 6);
+static_assert(mul_div(INT64_MAX, 1000, 1000) == INT64_MAX);
+static_assert(price_ratio{3, 7}.apply_ceil(10) == 5);
@@ -0,0 +1,76 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace eosio;
+
+//Counters of the instrumented build, PERF_COUNT compiles to nothing without -DPERF_COUNTERS
+#ifdef PERF_COUNTERS
+
+struct perf_values
+{
+    uint64_t redemption_iterations = 0;
+    uint64_t deposits_erased = 0;
+    uint64_t deposits_modified = 0;
+    uint64_t inline_transfers = 0;
+    uint64_t notify_actions = 0;
+    uint64_t transactions_parsed = 0;
+    uint64_t trx_bytes_read = 0;
+
+    perf_values &operator+=(const perf_values &v)
+    {
+        redemption_iterations += v.redemption_iterations;
+        deposits_erased += v.deposits_erased;
+        deposits_modified += v.deposits_modified;
+        inline_transfers += v.inline_transfers;
+        notify_actions += v.notify_actions;
+        transactions_parsed += v.transactions_parsed;
+        trx_bytes_read += v.trx_bytes_read;
+        return *this;
+    }
+
+    void raise_to(const perf_values &v)
+    {
+        redemption_iterations = std::max(redemption_iterations, v.redemption_iterations);
+        deposits_erased = std::max(deposits_erased, v.deposits_erased);
+        deposits_modified = std::max(deposits_modified, v.deposits_modified);
+        inline_transfers = std::max(inline_transfers, v.inline_transfers);
+        notify_actions = std::max(notify_actions, v.notify_actions);
+        transactions_parsed = std::max(transactions_parsed, v.transactions_parsed);
+        trx_bytes_read = std::max(trx_bytes_read, v.trx_bytes_read);
+    }
+
+    EOSLIB_SERIALIZE(perf_values, (redemption_iterations)(deposits_erased)(deposits_modified)(inline_transfers)
+                                  (notify_actions)(transactions_parsed)(trx_bytes_read))
+};
+
+//Highest values reached by a single execution of the action, notifications are kept apart by their code
+struct perf_mark
+{
+    name code;
+    name action;
+    perf_values max;
+
+    EOSLIB_SERIALIZE(perf_mark, (code)(action)(max))
+};
+
+struct [[eosio::contract("token.pc"), eosio::table]] perf_counter
+{
+    perf_values total;
+    std::vector<perf_mark> marks;
+};
+using perf_counters = singleton<name("perfcounter"), perf_counter>;
+
+//Set by apply before the action is dispatched
+inline name perf_code;
+inline name perf_action;
+
+#define PERF_COUNT(counter, value) (perf.counter += (value))
+
+#else
+
+#define PERF_COUNT(counter, value) ((void)0)
+
+#endif
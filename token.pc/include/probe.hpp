@@ -0,0 +1,43 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+
+using namespace eosio;
+
+//Scoped timing probes of the TRACE_PROBES build. Every probe prints one record on enter and one on exit:
+//  @>label time
+//  @<label time
+//scripts/probe_report.py folds a nodeos --contracts-console log of these records into cost tables.
+#ifdef TRACE_PROBES
+
+//Block time on chain, the native benchmarks define their own clock
+#ifndef PROBE_CLOCK
+#define PROBE_CLOCK() current_time_point().time_since_epoch().count()
+#endif
+
+class scoped_probe
+{
+private:
+    const char *label;
+
+public:
+    explicit scoped_probe(const char *_label) : label(_label)
+    {
+        print("@>", label, " ", static_cast<uint64_t>(PROBE_CLOCK()), "\n");
+    }
+
+    ~scoped_probe()
+    {
+        print("@<", label, " ", static_cast<uint64_t>(PROBE_CLOCK()), "\n");
+    }
+};
+
+#define PROBE_NAME(line) probe_##line
+#define PROBE_AT(label, line) scoped_probe PROBE_NAME(line)(label)
+#define PROBE(label) PROBE_AT(label, __LINE__)
+
+#else
+
+#define PROBE(label) ((void)0)
+
+#endif
@@ -0,0 +1,316 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "deposit.hpp"
+#include "redemption_tree.hpp"
+
+using namespace eosio;
+
+//Whole deposits at the front of the redemption order, cut off the book by take_prefix
+struct redemption_cut
+{
+    uint64_t root;
+    int64_t cash;
+    int64_t usdt;
+};
+
+//Order statistics over the deposits in redemption order, kept in the rdmtree treap.
+//Nodes are read once per action, changed in memory and written back by save(), so every node
+//on a split or merge path costs one write however often it is touched.
+//Deposits not yet added by the migration are not part of the book and can not be redeemed.
+class redemption_book
+{
+private:
+    struct entry
+    {
+        redemption_node node;
+        bool stored = false;
+        bool dirty = false;
+        bool erased = false;
+    };
+
+    name self;
+    redemption_nodes _nodes;
+    redemption_roots _roots;
+    std::map<uint64_t, entry> _cache;
+    std::optional<uint64_t> _root;
+    bool _root_dirty = false;
+
+    static uint64_t priority(uint64_t id)
+    {
+        id += 0x9e3779b97f4a7c15ull;
+        id = (id ^ (id >> 30)) * 0xbf58476d1ce4e5b9ull;
+        id = (id ^ (id >> 27)) * 0x94d049bb133111ebull;
+        return id ^ (id >> 31);
+    }
+
+    entry *find(const uint64_t &id)
+    {
+        auto it = _cache.find(id);
+        if (it == _cache.end())
+        {
+            auto row = _nodes.find(id);
+            if (row == _nodes.end())
+                return nullptr;
+            it = _cache.emplace(id, entry{*row, true}).first;
+        }
+        return it->second.erased ? nullptr : &it->second;
+    }
+
+    const redemption_node &read(const uint64_t &id)
+    {
+        auto e = find(id);
+        check(e != nullptr, "redemption_book : node is not found");
+        return e->node;
+    }
+
+    redemption_node &edit(const uint64_t &id)
+    {
+        auto e = find(id);
+        check(e != nullptr, "redemption_book : node is not found");
+        e->dirty = true;
+        return e->node;
+    }
+
+    int64_t sum_cash(const uint64_t &id) { return id == no_redemption_node ? 0 : read(id).sum_cash; }
+    int64_t sum_usdt(const uint64_t &id) { return id == no_redemption_node ? 0 : read(id).sum_usdt; }
+
+    void set_parent(const uint64_t &child, const uint64_t &parent)
+    {
+        if (child != no_redemption_node)
+            edit(child).parent = parent;
+    }
+
+    void pull(const uint64_t &id)
+    {
+        auto &n = edit(id);
+        n.sum_cash = n.cash + sum_cash(n.left) + sum_cash(n.right);
+        n.sum_usdt = n.usdt + sum_usdt(n.left) + sum_usdt(n.right);
+    }
+
+    void set_root(const uint64_t &id)
+    {
+        _root = id;
+        _root_dirty = true;
+        set_parent(id, no_redemption_node);
+    }
+
+    uint64_t merge(uint64_t a, uint64_t b)
+    {
+        if (a == no_redemption_node)
+            return b;
+        if (b == no_redemption_node)
+            return a;
+
+        if (read(a).priority > read(b).priority)
+        {
+            auto right = merge(read(a).right, b);
+            edit(a).right = right;
+            set_parent(right, a);
+            pull(a);
+            return a;
+        }
+
+        auto left = merge(a, read(b).left);
+        edit(b).left = left;
+        set_parent(left, b);
+        pull(b);
+        return b;
+    }
+
+    //Nodes ordered before (key, id) go left
+    std::pair<uint64_t, uint64_t> split_key(uint64_t t, uint128_t key, uint64_t id)
+    {
+        if (t == no_redemption_node)
+            return {no_redemption_node, no_redemption_node};
+
+        const auto &n = read(t);
+        if (std::tie(n.key, n.id) < std::tie(key, id))
+        {
+            auto [left, right] = split_key(n.right, key, id);
+            edit(t).right = left;
+            set_parent(left, t);
+            pull(t);
+            return {t, right};
+        }
+
+        auto [left, right] = split_key(n.left, key, id);
+        edit(t).left = right;
+        set_parent(right, t);
+        pull(t);
+        return {left, t};
+    }
+
+    //The longest prefix whose whole deposits hold at most cash goes left
+    std::pair<uint64_t, uint64_t> split_cash(uint64_t t, int64_t cash)
+    {
+        if (t == no_redemption_node)
+            return {no_redemption_node, no_redemption_node};
+
+        const auto &n = read(t);
+        int64_t before = sum_cash(n.left) + n.cash;
+        if (before <= cash)
+        {
+            auto [left, right] = split_cash(n.right, cash - before);
+            edit(t).right = left;
+            set_parent(left, t);
+            pull(t);
+            return {t, right};
+        }
+
+        auto [left, right] = split_cash(n.left, cash);
+        edit(t).left = right;
+        set_parent(right, t);
+        pull(t);
+        return {left, t};
+    }
+
+public:
+    explicit redemption_book(const name &_self) : self(_self), _nodes(_self, _self.value), _roots(_self, _self.value) {}
+
+    uint64_t root()
+    {
+        if (!_root)
+            _root = _roots.get_or_default(redemption_root{no_redemption_node}).root;
+        return *_root;
+    }
+
+    bool contains(const uint64_t &id) { return find(id) != nullptr; }
+
+    //Deposits of a redeemed subtree stay in the deposits table until they are settled
+    bool is_reserved(const uint64_t &id)
+    {
+        if (!contains(id))
+            return false;
+
+        auto top = id;
+        while (read(top).parent != no_redemption_node)
+            top = read(top).parent;
+        return top != root();
+    }
+
+    int64_t total_cash() { return sum_cash(root()); }
+
+    uint64_t front()
+    {
+        auto id = root();
+        check(id != no_redemption_node, "redemption_book : book is empty");
+        while (read(id).left != no_redemption_node)
+            id = read(id).left;
+        return id;
+    }
+
+    void insert(const place &deposit)
+    {
+        check(!contains(deposit.id), "redemption_book : deposit is already in the book");
+
+        auto &e = _cache[deposit.id];
+        e.node = redemption_node{deposit.id, no_redemption_node, no_redemption_node, no_redemption_node, priority(deposit.id),
+                                 deposit.mlnk_in_and_date_key(), deposit.cash_amount, deposit.usdt_amount,
+                                 deposit.cash_amount, deposit.usdt_amount};
+        e.dirty = true;
+        e.erased = false;
+
+        auto [left, right] = split_key(root(), e.node.key, deposit.id);
+        set_root(merge(merge(left, deposit.id), right));
+    }
+
+    void erase(const uint64_t &id)
+    {
+        const auto n = read(id);
+        auto child = merge(n.left, n.right);
+        set_parent(child, n.parent);
+
+        if (n.parent == no_redemption_node)
+        {
+            check(id == root(), "redemption_book : deposit is reserved by a redemption");
+            set_root(child);
+        }
+        else
+        {
+            auto &p = edit(n.parent);
+            (p.left == id ? p.left : p.right) = child;
+            for (auto up = n.parent; up != no_redemption_node; up = read(up).parent)
+                pull(up);
+        }
+
+        auto &e = _cache[id];
+        e.dirty = true;
+        e.erased = true;
+    }
+
+    //Keeps the node in step with a changed deposit, rows the migration has not reached yet are added
+    void update(const place &deposit)
+    {
+        if (contains(deposit.id))
+            erase(deposit.id);
+        insert(deposit);
+    }
+
+    //Cuts the longest prefix of whole deposits holding at most cash off the book
+    redemption_cut take_prefix(const int64_t &cash)
+    {
+        auto [taken, rest] = split_cash(root(), cash);
+        set_root(rest);
+        set_parent(taken, no_redemption_node);
+        return redemption_cut{taken, sum_cash(taken), sum_usdt(taken)};
+    }
+
+    //Drops a settled node of a redeemed subtree and returns its children as new subtree roots
+    std::vector<uint64_t> release(const uint64_t &id)
+    {
+        const auto n = read(id);
+        std::vector<uint64_t> children;
+        for (const auto &child : {n.left, n.right})
+        {
+            if (child == no_redemption_node)
+                continue;
+            set_parent(child, no_redemption_node);
+            children.push_back(child);
+        }
+
+        auto &e = _cache[id];
+        e.dirty = true;
+        e.erased = true;
+        return children;
+    }
+
+    void save()
+    {
+        for (auto &[id, e] : _cache)
+        {
+            if (!e.dirty)
+                continue;
+
+            if (e.erased)
+            {
+                if (e.stored)
+                    _nodes.erase(_nodes.find(id));
+            }
+            else if (e.stored)
+            {
+                _nodes.modify(_nodes.find(id), same_payer, [&](auto &n) {
+                    n = e.node;
+                });
+            }
+            else
+            {
+                _nodes.emplace(self, [&](auto &n) {
+                    n = e.node;
+                });
+            }
+            e.stored = !e.erased;
+            e.dirty = false;
+        }
+
+        if (_root_dirty)
+        {
+            _roots.set(redemption_root{*_root}, self);
+            _root_dirty = false;
+        }
+    }
+};
@@ -2,6 +2,7 @@
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/crypto.hpp>
+#include <string_view>
 
 using namespace eosio;
 
@@ -17,6 +18,7 @@ using namespace eosio;
     const uint32_t initial_period = 2;
     const uint32_t max_inh_period = 5;
     const uint32_t royalty_n_income_period = 60;
+    const uint32_t inh_extend_tolerance = 0;
 #else
     #ifdef PREPROD
         constexpr name TETHER_ACCOUNT("aabw2r.pcash");
@@ -30,6 +32,7 @@ using namespace eosio;
         const uint32_t initial_period = 31536000; //1 year in secs
         const uint32_t max_inh_period = 315360000; //10 years in secs
         const uint32_t royalty_n_income_period = 86400; //1 day
+        const uint32_t inh_extend_tolerance = 3600; //1 hour
     #else
         constexpr name TETHER_ACCOUNT("tethertether");
         constexpr name SWAP_PCASH_ACCOUNT("swap.pcash");
@@ -42,9 +45,12 @@ using namespace eosio;
         const uint32_t initial_period = 31536000; //1 year in secs
         const uint32_t max_inh_period = 315360000; //10 years in secs
         const uint32_t royalty_n_income_period = 86400; //1 day
+        const uint32_t inh_extend_tolerance = 3600; //1 hour
     #endif
 #endif
 
+static_assert(inh_extend_tolerance < min_inh_period, "inh_extend_tolerance must be less than min_inh_period");
+
 constexpr symbol USDCASH("USDCASH", 5);
 
 constexpr symbol inh_percent("PERCENT", 1);
@@ -53,24 +59,19 @@ const asset max_percent(1000, inh_percent);
 
 const uint32_t usdcash_package_amount = 10000000;
 const uint32_t exchange_multiplier = 100;
-
-struct transfer_action
-{
-    name from;
-    name to;
-    asset quantity;
-    std::string memo;
-
-    EOSLIB_SERIALIZE(transfer_action, (from)(to)(quantity)(memo))
-};
+const uint32_t max_redemption_rows = 50; //deposits consumed per action
+const uint32_t deposit_settlement_rows = 10; //redeemed deposits settled by each new deposit
+const int64_t dust_cash_amount = usdcash_package_amount; //deposits that can not be swapped back
+const uint32_t max_inheritance_rows = 50; //inheritance owners processed per action
+const uint32_t staged_deposit_period = 3600; //staged deposit legs are refundable by anyone after 1 hour
+constexpr std::string_view staged_deposit_memo = "stage";
+const uint128_t royalty_precision = 1000000000000; //reward per share scale
 
 struct deposit
 {
     name from;
     extended_asset quantity;
-    std::string memo;
-
-    EOSLIB_SERIALIZE(deposit, (from)(quantity)(memo))
+    std::string_view memo;
 };
 
 bool operator==(const deposit &lhs, const deposit &rhs)
@@ -0,0 +1,89 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <map>
+#include <optional>
+#include "account.hpp"
+#include "stat.hpp"
+#include "royalty_holder.hpp"
+#include "royalty_pool.hpp"
+#include "inheritance.hpp"
+#include "reverse.hpp"
+#include "income.hpp"
+#include "deposit.hpp"
+#include "redemption.hpp"
+#include "redemption_book.hpp"
+#include "claim.hpp"
+#include "staged_deposit.hpp"
+
+using namespace eosio;
+
+//Per-action table handles. Every table is opened once on first use and shared by all helpers,
+//so rows read by one helper are served from the multi_index cache to the next one.
+class state_context
+{
+private:
+    name self;
+
+    std::map<uint64_t, stats> _stats;
+    std::map<std::pair<uint64_t, uint64_t>, accounts> _accounts;
+    std::optional<inheritance> _inheritance;
+    std::optional<deposits> _deposits;
+    std::optional<royalties> _royalties;
+    std::optional<royalty_pools> _royalty_pools;
+    std::optional<reverse_table> _reverse_table;
+    std::optional<swap_table> _swap_table;
+    std::optional<redemptions> _redemptions;
+    std::optional<redemption_book> _redemption_book;
+    std::optional<claims> _claims;
+    std::optional<staged_deposits> _staged_deposits;
+
+    template <typename T>
+    T &open(std::optional<T> &table)
+    {
+        if (!table)
+            table.emplace(self, self.value);
+        return *table;
+    }
+
+public:
+    explicit state_context(const name &_self) : self(_self) {}
+
+    stats &get_stats(const uint64_t &sym_code_raw)
+    {
+        return _stats.try_emplace(sym_code_raw, self, sym_code_raw).first->second;
+    }
+
+    accounts &get_accounts(const name &owner)
+    {
+        return get_accounts(self, owner);
+    }
+
+    accounts &get_accounts(const name &contract, const name &owner)
+    {
+        return _accounts.try_emplace(std::make_pair(contract.value, owner.value), contract, owner.value).first->second;
+    }
+
+    inheritance &get_inheritance() { return open(_inheritance); }
+    deposits &get_deposits() { return open(_deposits); }
+    royalties &get_royalties() { return open(_royalties); }
+    royalty_pools &get_royalty_pools() { return open(_royalty_pools); }
+    reverse_table &get_reverse_table() { return open(_reverse_table); }
+    swap_table &get_swap_table() { return open(_swap_table); }
+    redemptions &get_redemptions() { return open(_redemptions); }
+
+    redemption_book &get_redemption_book()
+    {
+        if (!_redemption_book)
+            _redemption_book.emplace(self);
+        return *_redemption_book;
+    }
+    claims &get_claims() { return open(_claims); }
+    staged_deposits &get_staged_deposits() { return open(_staged_deposits); }
+
+    //Writes back the state kept in memory during the action
+    void save()
+    {
+        if (_redemption_book)
+            _redemption_book->save();
+    }
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+#include <string_view>
+#include <string.h>
+
+using namespace eosio;
+
+//Forward-only reader over a packed transaction as returned by read_transaction.
+//Only transfer actions are decoded, everything else is skipped by its length prefix.
+
+struct transfer_view
+{
+    name account;
+    name from;
+    name to;
+    asset quantity;
+    std::string_view memo;
+};
+
+class byte_reader
+{
+private:
+    const char *pos;
+    const char *end;
+
+public:
+    byte_reader(const char *data, const uint64_t &size) : pos(data), end(data + size) {}
+
+    void require(const uint64_t &size) const
+    {
+        check(size <= (uint64_t)(end - pos), "transaction_reader : unexpected end of data");
+    }
+
+    template <typename T>
+    T read()
+    {
+        require(sizeof(T));
+        T value;
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    uint32_t read_varuint32()
+    {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        uint8_t byte = 0;
+        do
+        {
+            byte = read<uint8_t>();
+            value |= uint32_t(byte & 0x7f) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && shift < 35);
+        return value;
+    }
+
+    const char *skip(const uint64_t &size)
+    {
+        require(size);
+        const char *begin = pos;
+        pos += size;
+        return begin;
+    }
+};
+
+class transaction_reader
+{
+private:
+    byte_reader reader;
+    uint32_t actions_left = 0;
+
+    void skip_action()
+    {
+        reader.skip(2 * sizeof(uint64_t));                     //account, name
+        reader.skip((uint64_t)reader.read_varuint32() * 16); //authorization
+        reader.skip(reader.read_varuint32());                  //data
+    }
+
+public:
+    transaction_reader(const char *data, const uint64_t &size) : reader(data, size)
+    {
+        reader.skip(sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint32_t)); //expiration, ref_block_num, ref_block_prefix
+        reader.read_varuint32();                                              //max_net_usage_words
+        reader.skip(sizeof(uint8_t));                                         //max_cpu_usage_ms
+        reader.read_varuint32();                                              //delay_sec
+
+        for (auto cfa_left = reader.read_varuint32(); cfa_left > 0; --cfa_left)
+            skip_action();
+
+        actions_left = reader.read_varuint32();
+    }
+
+    bool next_transfer(transfer_view &transfer)
+    {
+        while (actions_left > 0)
+        {
+            --actions_left;
+            auto account = name(reader.read<uint64_t>());
+            auto action_name = name(reader.read<uint64_t>());
+            reader.skip((uint64_t)reader.read_varuint32() * 16);
+            auto size = reader.read_varuint32();
+            const char *data = reader.skip(size);
+
+            if (action_name != name("transfer"))
+                continue;
+
+            byte_reader args(data, size);
+            transfer.account = account;
+            transfer.from = name(args.read<uint64_t>());
+            transfer.to = name(args.read<uint64_t>());
+            transfer.quantity.amount = args.read<int64_t>();
+            transfer.quantity.symbol = symbol(args.read<uint64_t>());
+            auto memo_size = args.read_varuint32();
+            transfer.memo = std::string_view(args.skip(memo_size), memo_size);
+            return true;
+        }
+        return false;
+    }
+};
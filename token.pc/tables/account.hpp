@@ -10,4 +10,13 @@ struct [[eosio::contract("token.pc"), eosio::table]] account
 
     uint64_t primary_key() const { return balance.symbol.code().raw(); }
 };
-using accounts = multi_index< name("accounts"), account>;
\ No newline at end of file
+using accounts = multi_index< name("accounts"), account>;
+
+struct transfer_record
+{
+    name to;
+    asset quantity;
+    std::string memo;
+
+    EOSLIB_SERIALIZE(transfer_record, (to)(quantity)(memo))
+};
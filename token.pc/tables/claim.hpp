@@ -0,0 +1,15 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+
+//MLNK returned to depositors by redemptions, withdrawn with the claim action
+struct [[eosio::contract("token.pc"), eosio::table]] claim_balance
+{
+    name owner;
+    asset quantity;
+
+    uint64_t primary_key() const { return owner.value; }
+};
+using claims = multi_index<name("claims"), claim_balance>;
@@ -1,22 +1,71 @@
 #pragma once
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/singleton.hpp>
+#include "resourses.hpp"
 
 using namespace eosio;
 
+//Amounts are stored without symbols, the symbols are always MLNK, USDT and USDCASH.
+//Row data: 44 bytes, the legacy layout with three full assets took 68 bytes.
+//Legacy rows are still readable and are rewritten in the packed layout on the next modify.
 struct [[eosio::contract("token.pc"), eosio::table]] place
 {
     uint64_t id;
     name owner;
-    asset mlnk_in;
-    asset usdt_in;
-    asset token_out;
+    int64_t mlnk_amount;
+    int64_t usdt_amount;
+    int64_t cash_amount;
     time_point_sec creation_date;
 
     uint64_t primary_key() const { return id; }
     uint64_t owner_key() const { return owner.value; }
-    uint128_t mlnk_in_and_date_key() const { return ((uint128_t)mlnk_in.amount << 64)|(uint128_t)creation_date.sec_since_epoch(); }
+    uint128_t mlnk_in_and_date_key() const { return ((uint128_t)mlnk_amount << 64)|(uint128_t)creation_date.sec_since_epoch(); }
+
+    asset get_mlnk_in() const { return asset(mlnk_amount, MLNK.get_symbol()); }
+    asset get_usdt_in() const { return asset(usdt_amount, USDT.get_symbol()); }
+    asset get_token_out() const { return asset(cash_amount, USDCASH); }
+
+    template <typename DataStream>
+    friend DataStream &operator<<(DataStream &ds, const place &p)
+    {
+        return ds << p.id << p.owner << p.mlnk_amount << p.usdt_amount << p.cash_amount << p.creation_date;
+    }
+
+    template <typename DataStream>
+    friend DataStream &operator>>(DataStream &ds, place &p)
+    {
+        const size_t legacy_size = 3 * (sizeof(int64_t) + sizeof(uint64_t)) + sizeof(uint32_t);
+        ds >> p.id >> p.owner;
+        if (ds.remaining() == legacy_size)
+        {
+            asset mlnk_in, usdt_in, token_out;
+            ds >> mlnk_in >> usdt_in >> token_out;
+            p.mlnk_amount = mlnk_in.amount;
+            p.usdt_amount = usdt_in.amount;
+            p.cash_amount = token_out.amount;
+        }
+        else
+        {
+            ds >> p.mlnk_amount >> p.usdt_amount >> p.cash_amount;
+        }
+        return ds >> p.creation_date;
+    }
 };
 using by_mlnk_in_and_date = indexed_by<name("bymlnkdate"), const_mem_fun<place, uint128_t, &place::mlnk_in_and_date_key>>;
 using by_owner = indexed_by<name("byowner"), const_mem_fun<place, uint64_t, &place::owner_key>>;
 using deposits = multi_index<name("deposits"), place, by_mlnk_in_and_date, by_owner >;
+
+struct swap_back_record
+{
+    uint64_t id;
+    asset cash;
+
+    EOSLIB_SERIALIZE(swap_back_record, (id)(cash))
+};
+
+struct [[eosio::contract("token.pc"), eosio::table]] deposit_cursor
+{
+    uint64_t next_id;
+};
+using deposit_cursors = singleton<name("depcursor"), deposit_cursor>;
@@ -1,6 +1,7 @@
 #pragma once
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/singleton.hpp>
 #include <eosio/system.hpp>
 #include <eosio/time.hpp>
 
@@ -32,3 +33,10 @@ struct [[eosio::contract("token.pc"), eosio::table]] member
 };
 using by_date = indexed_by<name("bydate"), const_mem_fun<member, uint64_t, &member::date_key>>;
 using inheritance = multi_index<name("inheritance"), member, by_date>;
+
+struct [[eosio::contract("token.pc"), eosio::table]] inheritance_cursor
+{
+    time_point_sec inheritance_date;
+    name user_name;
+};
+using inheritance_cursors = singleton<name("inhcursor"), inheritance_cursor>;
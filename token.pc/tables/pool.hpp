@@ -1,6 +1,8 @@
 #pragma once
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/singleton.hpp>
+#include <limits>
 #include "resourses.hpp"
 
 using namespace eosio;
@@ -28,7 +30,21 @@ struct [[eosio::table]] pool
     checksum256 pair_key() const {
         return to_pair_hash(token1.get_extended_symbol(), token2.get_extended_symbol());
     }
+
+    bool has_pair(const extended_symbol &first, const extended_symbol &second) const {
+        return (token1.get_extended_symbol() == first && token2.get_extended_symbol() == second) ||
+               (token1.get_extended_symbol() == second && token2.get_extended_symbol() == first);
+    }
 };
 using by_code = indexed_by<name("bycode"), const_mem_fun<pool, uint64_t, &pool::code_key>>;
 using by_pair_key = indexed_by<name("bypair"), const_mem_fun<pool, checksum256, &pool::pair_key>>;
-using pools = multi_index<name("pools"), pool, by_code, by_pair_key>;
\ No newline at end of file
+using pools = multi_index<name("pools"), pool, by_code, by_pair_key>;
+
+//Id of the MLNK/USDT pool in swap.pcash, resolved by pair hash once and then read by primary key
+struct [[eosio::contract("token.pc"), eosio::table]] pool_ref
+{
+    uint64_t pool_id;
+};
+using pool_refs = singleton<name("poolref"), pool_ref>;
+
+const uint64_t no_pool_id = std::numeric_limits<uint64_t>::max();
@@ -0,0 +1,13 @@
+#pragma once
+#include <eosio/eosio.hpp>
+
+using namespace eosio;
+
+//Root of a redeemed rdmtree subtree. The redeemer is already paid, its deposits are settled to their owners by processrdm.
+struct [[eosio::contract("token.pc"), eosio::table]] redemption_pending
+{
+    uint64_t id;
+
+    uint64_t primary_key() const { return id; }
+};
+using redemptions = multi_index<name("rdmpending"), redemption_pending>;
@@ -0,0 +1,33 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <limits>
+
+using namespace eosio;
+
+//Treap over the bymlnkdate order of deposits, one node per deposit with the same id.
+//Nodes are ordered by (mlnk_in_and_date_key, id) like the index and keep the cash and USDT sums of their subtree.
+struct [[eosio::contract("token.pc"), eosio::table]] redemption_node
+{
+    uint64_t id;
+    uint64_t parent;
+    uint64_t left;
+    uint64_t right;
+    uint64_t priority;
+    uint128_t key;
+    int64_t cash;
+    int64_t usdt;
+    int64_t sum_cash;
+    int64_t sum_usdt;
+
+    uint64_t primary_key() const { return id; }
+};
+using redemption_nodes = multi_index<name("rdmtree"), redemption_node>;
+
+struct [[eosio::contract("token.pc"), eosio::table]] redemption_root
+{
+    uint64_t root;
+};
+using redemption_roots = singleton<name("rdmroot"), redemption_root>;
+
+const uint64_t no_redemption_node = std::numeric_limits<uint64_t>::max();
@@ -29,6 +29,16 @@ asset royalty_holder::get_royalty() const
     return royalty;
 }
 
+uint128_t royalty_holder::get_checkpoint() const
+{
+    return checkpoint.value_or(0);
+}
+
+int64_t royalty_holder::get_pending() const
+{
+    return pending.value_or(0);
+}
+
 void royalty_holder::set_date(const time_point_sec &_date)
 {
     date = _date;
@@ -43,3 +53,9 @@ void royalty_holder::set_royalty(const asset &_royalty)
 {
     royalty = _royalty;
 }
+
+void royalty_holder::set_checkpoint(const uint128_t &_checkpoint, const int64_t &_pending)
+{
+    checkpoint.emplace(_checkpoint);
+    pending.emplace(_pending);
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/singleton.hpp>
 
 using namespace eosio;
 
@@ -10,6 +12,8 @@ private:
     time_point_sec date;
     name account;
     asset royalty;
+    binary_extension<uint128_t> checkpoint;
+    binary_extension<int64_t> pending;
 
 public:
     royalty_holder();
@@ -19,11 +23,37 @@ public:
     time_point_sec get_date() const;
     name get_account() const;
     asset get_royalty() const;
+    uint128_t get_checkpoint() const;
+    int64_t get_pending() const;
 
     void set_date(const time_point_sec &_date);
     void set_account(const name &_account);
     void set_royalty(const asset &_royalty);
+    void set_checkpoint(const uint128_t &_checkpoint, const int64_t &_pending);
 
-    EOSLIB_SERIALIZE(royalty_holder, (date)(account)(royalty))
+    EOSLIB_SERIALIZE(royalty_holder, (date)(account)(royalty)(checkpoint)(pending))
 };
-using royalties = multi_index<name("royalties"), royalty_holder>;
\ No newline at end of file
+using royalties = multi_index<name("royalties"), royalty_holder>;
+
+struct royalty_record
+{
+    name account;
+    asset royalty;
+
+    EOSLIB_SERIALIZE(royalty_record, (account)(royalty))
+};
+
+//Running sum of all holders royalty shares
+struct [[eosio::contract("token.pc"), eosio::table]] royalty_sum
+{
+    asset total;
+};
+using royalty_sums = singleton<name("royaltysum"), royalty_sum>;
+
+//Contract balances being paid out by getroyalties and the next holder to pay
+struct [[eosio::contract("token.pc"), eosio::table]] royalty_round
+{
+    uint64_t next_holder;
+    std::vector<asset> balances;
+};
+using royalty_rounds = singleton<name("royaltyround"), royalty_round>;
@@ -0,0 +1,14 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+
+struct [[eosio::contract("token.pc"), eosio::table]] royalty_pool
+{
+    asset total;
+    uint128_t reward_per_share;
+
+    uint64_t primary_key() const { return total.symbol.code().raw(); }
+};
+using royalty_pools = multi_index<name("royaltypool"), royalty_pool>;
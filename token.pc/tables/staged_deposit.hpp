@@ -0,0 +1,16 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+
+//First leg of a deposit sent with the staging memo, waiting for the opposite token
+struct [[eosio::contract("token.pc"), eosio::table]] staged_deposit
+{
+    name owner;
+    extended_asset quantity;
+    time_point_sec creation_date;
+
+    uint64_t primary_key() const { return owner.value; }
+};
+using staged_deposits = multi_index<name("staged"), staged_deposit>;
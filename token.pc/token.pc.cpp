@@ -1,37 +1,91 @@
 #include "token.pc.hpp"
 
 token::token(name receiver, name code, datastream<const char *> ds)
-    : contract::contract(receiver, code, ds)
+    : contract::contract(receiver, code, ds), ctx(receiver)
 {
 }
 
-void token::migration_data(const uint64_t &id)
+token::~token()
+{
+    ctx.save();
+    send_events();
+#ifdef PERF_COUNTERS
+    save_perf_counters();
+#endif
+}
+
+void token::migrate_deposits(const uint32_t &max_rows)
 {
     require_auth(get_self());
-    deposits _deposits(get_self(), get_self().value);
-    auto it = _deposits.find(id);
+    check(max_rows > 0, "migrate_deposits : invalid rows amount");
 
-    if (it != _deposits.end())
-    {
-        const auto &deposit = *it;
-        _deposits.erase(it);
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+    deposit_cursors _cursors(get_self(), get_self().value);
+    auto cursor = _cursors.get_or_default(deposit_cursor{0});
 
-       _deposits.emplace(get_self(), [&](auto &a) {
-        a.id = _deposits.available_primary_key();
-        a.owner = deposit.owner;
-        a.mlnk_in = deposit.mlnk_in;
-        a.usdt_in = deposit.usdt_in;
-        a.token_out = deposit.token_out;
-        a.creation_date = deposit.creation_date;
-    });
+    auto it = _deposits.lower_bound(cursor.next_id);
+    check(it != _deposits.end(), "migrate_deposits : deposits migration is finished");
+
+    for (uint32_t rows = 0; it != _deposits.end() && rows < max_rows; ++rows, ++it)
+    {
+        _deposits.modify(it, same_payer, [&](auto &a) {});
+        PERF_COUNT(deposits_modified, 1);
+        if (!book.contains(it->id))
+            book.insert(*it);
+        cursor.next_id = it->id + 1;
     }
 
+    _cursors.set(cursor, get_self());
+}
+
+void token::sweep_dust(const uint64_t &lower_id, const uint32_t &max_rows)
+{
+    require_auth(get_self());
+
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+    auto owner_index = _deposits.get_index<name("byowner")>();
+
+    auto it = _deposits.lower_bound(lower_id);
+    for (uint32_t rows = 0; it != _deposits.end() && rows < max_rows; ++rows)
+    {
+        if (it->cash_amount >= dust_cash_amount || book.is_reserved(it->id))
+        {
+            ++it;
+            continue;
+        }
+
+        auto target = owner_index.lower_bound(it->owner.value);
+        while (target != owner_index.end() && target->owner == it->owner && (target->id == it->id || book.is_reserved(target->id)))
+            ++target;
+
+        //A single dust row still backs its USDT and USDCASH, so it stays in the book for redemptions
+        if (target == owner_index.end() || target->owner != it->owner)
+        {
+            ++it;
+            continue;
+        }
+
+        owner_index.modify(target, same_payer, [&](auto &a) {
+            a.mlnk_amount += it->mlnk_amount;
+            a.usdt_amount += it->usdt_amount;
+            a.cash_amount += it->cash_amount;
+        });
+        PERF_COUNT(deposits_modified, 1);
+        book.update(*target);
+
+        if (book.contains(it->id))
+            book.erase(it->id);
+        it = _deposits.erase(it);
+        PERF_COUNT(deposits_erased, 1);
+    }
 }
 
 void token::set_inheritance_date(const name &owner, const uint32_t &inactive_period)
 {
     require_auth(get_self());
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto it = _inheritance.find(owner.value);
     check(it != _inheritance.end(), "set_inheritance_date : account is not found");
 
@@ -51,7 +105,7 @@ void token::add_swap_income(const extended_asset &income)
     check(ext_sym == USDT, "add_swap_income : income symbol is not USDT symbol");
     check(is_account(ext_sym.get_contract()), "add_swap_income : contract account is not exist");
 
-    swap_table _swap_table(get_self(), get_self().value);
+    auto &_swap_table = ctx.get_swap_table();
     auto it = _swap_table.find(ext_sym.get_symbol().code().raw());
     if (it == _swap_table.end())
     {
@@ -71,14 +125,14 @@ void token::add_swap_cash(const asset &cash)
 {
     require_auth(get_self());
 
-    stats statstable(get_self(), cash.symbol.code().raw());
+    auto &statstable = ctx.get_stats(cash.symbol.code().raw());
     auto existing = statstable.find(cash.symbol.code().raw());
     check(existing != statstable.end(), "add_rate_cash : token with symbol does not exist, create token before add");
     check(cash.symbol == existing->supply.symbol, "issue_token : symbol precision mismatch");
     check(cash.is_valid(), "add_rate_cash : invalid quantity");
     check(cash.amount > 0, "add_rate_cash : must add positive quantity");
 
-    reverse_table _reverse_table(get_self(), get_self().value);
+    auto &_reverse_table = ctx.get_reverse_table();
     auto it = _reverse_table.find(cash.symbol.code().raw());
 
     if (it == _reverse_table.end())
@@ -106,7 +160,7 @@ void token::create_token(const name &issuer, const asset &maximum_supply)
     check(maximum_supply.is_valid(), "create_token : invalid supply");
     check(maximum_supply.amount > 0, "create_token : max-supply must be positive");
 
-    stats statstable(get_self(), sym.code().raw());
+    auto &statstable = ctx.get_stats(sym.code().raw());
     auto existing = statstable.find(sym.code().raw());
     check(existing == statstable.end(), "create_token : token with symbol already exists");
 
@@ -122,7 +176,7 @@ void token::issue_token(const name &to, const asset &quantity, const std::string
     auto sym = quantity.symbol;
     check(sym.is_valid(), "issue_token : invalid symbol name");
 
-    stats statstable(get_self(), sym.code().raw());
+    auto &statstable = ctx.get_stats(sym.code().raw());
     auto existing = statstable.find(sym.code().raw());
     check(existing != statstable.end(), "issue_token : token with symbol does not exist, create token before issue");
     const auto &st = *existing;
@@ -151,7 +205,7 @@ void token::retire_token(const name &owner, const asset &quantity, const std::st
     check(sym.is_valid(), "retire_token : invalid symbol name");
     check(memo.size() <= 256, "retire_token : memo has more than 256 bytes");
 
-    stats statstable(get_self(), sym.code().raw());
+    auto &statstable = ctx.get_stats(sym.code().raw());
     auto existing = statstable.find(sym.code().raw());
     check(existing != statstable.end(), "retire_token : token with symbol does not exist");
     const auto &st = *existing;
@@ -176,7 +230,7 @@ void token::transfer_token(const name &from, const name &to,
     require_auth(from);
     check(is_account(to), "transfer_token : to account does not exist");
     auto sym = quantity.symbol.code();
-    stats statstable(get_self(), sym.raw());
+    auto &statstable = ctx.get_stats(sym.raw());
     const auto &st = statstable.get(sym.raw());
 
     require_recipient(from);
@@ -197,6 +251,49 @@ void token::transfer_token(const name &from, const name &to,
     on_transfer_self_token(from, to, quantity, memo);
 }
 
+void token::transfer_many(const name &from, const std::vector<transfer_record> &transfers)
+{
+    require_auth(from);
+    check(!transfers.empty(), "transfer_many : transfers are empty");
+    require_recipient(from);
+
+    std::map<uint64_t, asset> totals;
+    for (const auto &t : transfers)
+    {
+        check(from != t.to, "transfer_many : cannot transfer to self");
+        check(t.to != get_self(), "transfer_many : redemptions must use transfer");
+        check(t.quantity.is_valid(), "transfer_many : invalid quantity");
+        check(t.quantity.amount > 0, "transfer_many : must transfer positive quantity");
+        check(t.memo.size() <= 256, "transfer_many : memo has more than 256 bytes");
+
+        auto sym_code_raw = t.quantity.symbol.code().raw();
+        auto total = totals.find(sym_code_raw);
+        if (total == totals.end())
+        {
+            const auto &st = ctx.get_stats(sym_code_raw).get(sym_code_raw);
+            check(t.quantity.symbol == st.supply.symbol, "transfer_many : symbol precision mismatch");
+            totals.emplace(sym_code_raw, t.quantity);
+        }
+        else
+        {
+            check(t.quantity.symbol == total->second.symbol, "transfer_many : symbol precision mismatch");
+            total->second += t.quantity;
+        }
+    }
+
+    for (const auto &total : totals)
+        sub_balance(from, total.second);
+
+    for (const auto &t : transfers)
+    {
+        check(is_account(t.to), "transfer_many : to account does not exist");
+        require_recipient(t.to);
+        add_balance(t.to, t.quantity, has_auth(t.to) ? t.to : from);
+    }
+
+    extend_inheritance(from, from);
+}
+
 void token::open_account(const name &owner, const symbol &symbol, const name &ram_payer)
 {
     require_auth(ram_payer);
@@ -204,11 +301,11 @@ void token::open_account(const name &owner, const symbol &symbol, const name &ra
     check(is_account(owner), "open_account : owner account does not exist");
 
     auto sym_code_raw = symbol.code().raw();
-    stats statstable(get_self(), sym_code_raw);
+    auto &statstable = ctx.get_stats(sym_code_raw);
     const auto &st = statstable.get(sym_code_raw, "open_account : symbol does not exist");
     check(st.supply.symbol == symbol, "open_account : symbol precision mismatch");
 
-    accounts acnts(get_self(), owner.value);
+    auto &acnts = ctx.get_accounts(owner);
     auto it = acnts.find(sym_code_raw);
     if (it == acnts.end())
     {
@@ -223,7 +320,7 @@ void token::open_account(const name &owner, const symbol &symbol, const name &ra
 void token::close_account(const name &owner, const symbol &symbol)
 {
     require_auth(owner);
-    accounts acnts(get_self(), owner.value);
+    auto &acnts = ctx.get_accounts(owner);
     auto it = acnts.find(symbol.code().raw());
     check(it != acnts.end(), "close_account : Balance row already deleted or never existed. Action won't have any effect.");
     check(it->balance.amount == 0, "close_account : Cannot close because the balance is not zero.");
@@ -246,65 +343,122 @@ void token::distribute_mlnk()
     send_transfer(get_self(), MLNK_ACCOUNT, collect_mlnk, "collect mlnk");
 }
 
-void token::get_royalties(const name &ram_payer)
+void token::get_royalties(const name &ram_payer, const uint32_t &max_rows)
 {
     require_auth(ram_payer);
+    check(max_rows > 0, "get_royalties : max_rows must be positive");
+
+    auto &_royalties = ctx.get_royalties();
+    royalty_rounds _rounds(get_self(), get_self().value);
 
-    royalties _royalties(get_self(), get_self().value);
-    accounts _accounts(get_self(), get_self().value);
+    //A round pays every holder from the balances taken at its first call
+    royalty_round round{0, {}};
+    if (_rounds.exists())
+    {
+        round = _rounds.get();
+    }
+    else
+    {
+        for (const auto &acc : ctx.get_accounts(get_self()))
+        {
+            if (acc.balance.amount >= 1000)
+                round.balances.push_back(acc.balance);
+        }
+        check(!round.balances.empty(), "get_royalties : nothing to distribute");
+    }
 
-    std::vector<asset> balances;
-    for (const auto &acc : _accounts)
-        balances.push_back(acc.balance);
+    //Payouts are clamped to the current balances, which may have dropped below the snapshot
+    auto &_self_accounts = ctx.get_accounts(get_self());
+    std::vector<asset> totals;
+    std::vector<int64_t> available;
+    for (const auto &balance : round.balances)
+    {
+        auto acc = _self_accounts.find(balance.symbol.code().raw());
+        totals.push_back(asset(0, balance.symbol));
+        available.push_back(acc != _self_accounts.end() ? acc->balance.amount : 0);
+    }
 
-    for (const auto &i : _royalties)
+    auto it = _royalties.lower_bound(round.next_holder);
+    for (uint32_t rows = 0; it != _royalties.end() && rows < max_rows; ++rows, ++it)
     {
-        for (const auto &balance : balances)
-        {   
-            if (balance.amount >= 1000)
-            {
-                auto amount = count_share(balance, i.get_royalty());
-                send_transfer(get_self(), i.get_account(), amount, "royalty");
-            }
+        if (it->get_account() == get_self())
+            continue;
+
+        for (size_t i = 0; i < round.balances.size(); ++i)
+        {
+            auto amount = count_share(round.balances[i], it->get_royalty());
+            amount.amount = std::min(amount.amount, available[i] - totals[i].amount);
+            if (amount.amount <= 0)
+                continue;
+
+            add_balance(it->get_account(), amount, get_self());
+            emit_event(royalty_event, it->get_account(), get_self(), amount);
+            totals[i] += amount;
         }
     }
+
+    for (const auto &total : totals)
+    {
+        if (total.amount > 0)
+            sub_balance(get_self(), total);
+    }
+
+    if (it == _royalties.end())
+    {
+        _rounds.remove();
+    }
+    else
+    {
+        round.next_holder = it->primary_key();
+        _rounds.set(round, get_self());
+    }
+}
+
+void token::clear_royalty_round()
+{
+    require_auth(get_self());
+    royalty_rounds _rounds(get_self(), get_self().value);
+    check(_rounds.exists(), "clear_royalty_round : no royalty round in progress");
+    _rounds.remove();
 }
 
 void token::swap_back(const name &user, const asset &cash, const uint64_t &id)
 {
     require_auth(user);
-    
-    deposits _deposits(get_self(), get_self().value);
-    auto it = _deposits.find(id);
-    
-    check(it != _deposits.end(), "swap_back : deposit information is not found");
-    check(it->owner == user, "swap_back : the user is not the owner of the deposit");
-    check(cash.symbol == it->token_out.symbol, "swap_back : symbol precision mismatch");
-    check(cash.amount >= usdcash_package_amount && cash.amount % usdcash_package_amount == 0, "swap_back : invalid cash amount");
-    check(cash.amount <= it->token_out.amount, "swap_back : cash amount must be less then deposit amount");
-    check(is_account_exist(user, extended_symbol{USDT}), "swap_back : USDT account is not exist");
-    check(is_account_exist(user, extended_symbol{MLNK}), "swap_back : MLNK account is not exist");
+    swap_back_deposits(user, {swap_back_record{id, cash}});
+}
 
-    double rate = (double)it->token_out.amount / cash.amount;
-    asset send_mlnk = asset(it->mlnk_in.amount / rate, it->mlnk_in.symbol);
-    asset send_usdt = asset(it->usdt_in.amount / rate, it->usdt_in.symbol);
+void token::swap_back_many(const name &user, const std::vector<swap_back_record> &records)
+{
+    require_auth(user);
+    check(!records.empty(), "swap_back_many : records are empty");
+    swap_back_deposits(user, records);
+}
 
-    if (it->token_out.amount == cash.amount)
-    {
-        _deposits.erase(it);
-    }
-    else
+void token::swap_back_all(const name &user, const asset &cash)
+{
+    require_auth(user);
+    check(cash.symbol == USDCASH, "swap_back_all : symbol precision mismatch");
+    check(cash.amount >= usdcash_package_amount && cash.amount % usdcash_package_amount == 0, "swap_back_all : invalid cash amount");
+
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+    auto index = _deposits.get_index<name("byowner")>();
+
+    std::vector<swap_back_record> records;
+    int64_t rest = cash.amount;
+    for (auto it = index.lower_bound(user.value); it != index.end() && it->owner == user && rest > 0; ++it)
     {
-        _deposits.modify(it, same_payer, [&](auto &a) {
-            a.token_out -= cash;
-            a.usdt_in -= send_usdt;
-            a.mlnk_in -= send_mlnk;
-        });
+        int64_t amount = std::min(rest, it->cash_amount / usdcash_package_amount * usdcash_package_amount);
+        if (amount == 0 || book.is_reserved(it->id))
+            continue;
+
+        records.push_back(swap_back_record{it->id, asset(amount, USDCASH)});
+        rest -= amount;
     }
+    check(rest == 0, "swap_back_all : not enough deposits");
 
-    send_retire(user, cash, "");
-    send_transfer(TETHER_ACCOUNT, user, send_usdt, "");
-    send_transfer(SWAP_PCASH_ACCOUNT, user, send_mlnk, "");
+    swap_back_deposits(user, records);
 }
 
 void token::add_royalty_holder(const name &user_name, const asset &royalty)
@@ -312,64 +466,170 @@ void token::add_royalty_holder(const name &user_name, const asset &royalty)
     require_auth(get_self());
     check(is_account(user_name), "add_royalty_holder : user_name account not exist");
     check(is_valid_share(royalty), "add_royalty_holder : royalty not valid");
-    check(is_valid_royalties_sum(royalty), "add_royalty_holder : royalties sum not valid");
-    royalties _royalties(get_self(), get_self().value);
-    auto it = _royalties.find(user_name.value);
-    if (it == _royalties.end())
+
+    auto sum = get_royalties_sum();
+    sum += royalty - put_royalty_holder(user_name, royalty, get_reward_per_share(MLNK.get_symbol()));
+    check(is_valid_royalties_sum(sum), "add_royalty_holder : royalties sum not valid");
+    set_royalties_sum(sum);
+}
+
+void token::rmv_royalty_holder(const name &user_name)
+{
+    require_auth(get_self());
+    auto sum = get_royalties_sum();
+    sum -= erase_royalty_holder(user_name, get_reward_per_share(MLNK.get_symbol()));
+    set_royalties_sum(sum);
+}
+
+void token::set_royalties(const std::vector<royalty_record> &holders, const bool &replace)
+{
+    require_auth(get_self());
+    auto &_royalties = ctx.get_royalties();
+    auto reward_per_share = get_reward_per_share(MLNK.get_symbol());
+    auto sum = get_royalties_sum();
+
+    if (replace)
     {
-        auto current_day = get_current_day();
-        _royalties.emplace(get_self(), [&](auto &r) {
-            royalty_holder temp(current_day, user_name, royalty);
-            r = temp;
-        });
+        std::vector<uint64_t> kept;
+        for (const auto &h : holders)
+            kept.push_back(h.account.value);
+        std::sort(kept.begin(), kept.end());
+
+        std::vector<name> removed;
+        for (const auto &r : _royalties)
+        {
+            if (!std::binary_search(kept.begin(), kept.end(), r.primary_key()))
+                removed.push_back(r.get_account());
+        }
+        for (const auto &account : removed)
+            sum -= erase_royalty_holder(account, reward_per_share);
     }
-    else
+
+    for (const auto &h : holders)
     {
-        _royalties.modify(it, same_payer, [&](auto &r) {
-            r.set_royalty(royalty);
-        });
+        if (h.royalty.amount == 0)
+        {
+            if (_royalties.find(h.account.value) != _royalties.end())
+                sum -= erase_royalty_holder(h.account, reward_per_share);
+            continue;
+        }
+
+        check(is_account(h.account), "set_royalties : account not exist");
+        check(is_valid_share(h.royalty), "set_royalties : royalty not valid");
+        sum += h.royalty - put_royalty_holder(h.account, h.royalty, reward_per_share);
     }
+
+    check(is_valid_royalties_sum(sum), "set_royalties : royalties sum not valid");
+    set_royalties_sum(sum);
 }
 
-void token::rmv_royalty_holder(const name &user_name)
+void token::claim_royalty(const name &user_name)
 {
-    require_auth(get_self());
-    royalties _royalties(get_self(), get_self().value);
+    require_auth(user_name);
+    auto &_royalties = ctx.get_royalties();
     auto it = _royalties.find(user_name.value);
-    check(it != _royalties.end(), "rmv_royalty_holder : account not exist");
-    _royalties.erase(it);
+    check(it != _royalties.end(), "claim_royalty : account not exist");
+
+    auto reward_per_share = get_reward_per_share(MLNK.get_symbol());
+    auto pending = count_royalty(*it, reward_per_share);
+    check(pending > 0, "claim_royalty : nothing to claim");
+
+    _royalties.modify(it, same_payer, [&](auto &r) {
+        r.set_checkpoint(reward_per_share, 0);
+    });
+
+    send_transfer(MLNK.get_contract(), user_name, asset(pending, MLNK.get_symbol()), "royalty");
+}
+
+void token::claim_deposit(const name &user_name)
+{
+    require_auth(user_name);
+    auto &_claims = ctx.get_claims();
+    auto it = _claims.find(user_name.value);
+    check(it != _claims.end(), "claim_deposit : nothing to claim");
+
+    asset quantity = it->quantity;
+    _claims.erase(it);
+
+    send_transfer(SWAP_PCASH_ACCOUNT, user_name, quantity, "return of the deposit");
 }
 
 void token::distribute_inheritance(const name &initiator, const name &inheritance_owner, const symbol_code &token)
 {
     require_auth(initiator);
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto cur_date = current_time_point().sec_since_epoch();
     auto it = _inheritance.find(inheritance_owner.value);
     check(it != _inheritance.end(), "distribute_inheritance : inheritance_owner is not exist");
     check(it->inheritance_date.sec_since_epoch() < cur_date, "distribute_inheritance : inheritance date is not expired");
 
-    accounts from_acnts(get_self(), it->user_name.value);
+    auto &from_acnts = ctx.get_accounts(it->user_name);
     auto iter = from_acnts.find(token.raw());
     check(iter != from_acnts.end(), "distribute_inheritance : token is not exist");
     check(iter->balance.amount > 0, "distribute_inheritance : distribute amount should be positive");
 
-    if (it->inheritors.size() == 1 && it->inheritors.back().inheritor == get_self())
-    {
-        add_inh_balance(it->user_name, get_self(), iter->balance, initiator);
-    }
-    else
+    distribute_balance(*it, iter->balance, initiator);
+}
+
+void token::process_inheritances(const name &initiator, const uint32_t &max_rows)
+{
+    require_auth(initiator);
+    check(max_rows > 0 && max_rows <= max_inheritance_rows, "process_inheritances : invalid rows amount");
+
+    auto &_inheritance = ctx.get_inheritance();
+    inheritance_cursors _cursors(get_self(), get_self().value);
+    auto cursor = _cursors.get_or_default(inheritance_cursor{});
+    auto cur_date = current_time_point().sec_since_epoch();
+    auto index = _inheritance.get_index<name("bydate")>();
+
+    uint32_t rows = 0;
+    for (auto it = index.lower_bound(cursor.inheritance_date.utc_seconds); it != index.end() && rows < max_rows;)
     {
-        add_inh_balances(it->user_name, iter->balance, it->inheritors, initiator);
+        if (it->inheritance_date.sec_since_epoch() >= cur_date)
+            break;
+
+        if (it->inheritance_date == cursor.inheritance_date && it->user_name.value <= cursor.user_name.value)
+        {
+            ++it;
+            continue;
+        }
+
+        ++rows;
+        cursor.inheritance_date = it->inheritance_date;
+        cursor.user_name = it->user_name;
+
+        //A processed owner moves one inactive period forward, out of the range the crank scans again.
+        //Tokens it receives later are distributed by dstrinh.
+        auto owner = *it;
+        auto next = std::next(it);
+        index.modify(it, same_payer, [&](auto &m) {
+            m.inheritance_date = time_point_sec(m.inheritance_date.sec_since_epoch() + m.inactive_period);
+        });
+        it = next;
+
+        if (owner.user_name == get_self())
+            continue;
+
+        auto &from_acnts = ctx.get_accounts(owner.user_name);
+        std::vector<asset> balances;
+        for (const auto &acc : from_acnts)
+        {
+            if (acc.balance.amount > 0)
+                balances.push_back(acc.balance);
+        }
+
+        for (const auto &balance : balances)
+            distribute_balance(owner, balance, initiator);
     }
-    sub_balance(it->user_name, iter->balance);
-    send_notify("inheritance", it->user_name, name(), -iter->balance, "");
+    check(rows > 0, "process_inheritances : no expired inheritances");
+
+    _cursors.set(cursor, get_self());
 }
 
 void token::update_inheritance_date(const name &owner, const uint32_t &inactive_period)
 {
     require_auth(owner);
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto it = _inheritance.find(owner.value);
     check(it != _inheritance.end(), "update_inheritance_date : account is not found");
     check(is_valid_inactive_period(inactive_period), "update_inheritance_date : invalid inactive period");
@@ -384,7 +644,7 @@ void token::update_inheritance_date(const name &owner, const uint32_t &inactive_
 void token::update_inheritors(const name &owner, const std::vector<inheritor_record> &inheritors)
 {
     require_auth(owner);
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto it = _inheritance.find(owner.value);
     check(it != _inheritance.end(), "update_inheritors : account is not found");
     check(is_not_self_in_inheritors(owner, inheritors), "update_inheritors : owner can not be in inheritors list");
@@ -397,7 +657,7 @@ void token::update_inheritors(const name &owner, const std::vector<inheritor_rec
     });
 }
 
-void token::on_transfer(const name &from, const name &to, const asset &quantity, const std::string &memo)
+void token::on_transfer(const name &from, const name &to, const asset &quantity, std::string_view memo)
 {
     if (to == get_self())
     {
@@ -407,49 +667,115 @@ void token::on_transfer(const name &from, const name &to, const asset &quantity,
         }
         else if (get_first_receiver() == SWAP_PCASH_ACCOUNT || get_first_receiver() == TETHER_ACCOUNT)
         {
+            if (memo == staged_deposit_memo)
+            {
+                stage_deposit(from, extended_asset(quantity, get_first_receiver()), memo);
+                return;
+            }
+
             auto trx = get_income_trx();
             auto deposits = parse_deposit_actions(trx);
+            PERF_COUNT(transactions_parsed, 1);
+            PERF_COUNT(trx_bytes_read, trx.size());
             check(is_valid_deposits(deposits), "invalid deposits");
             deposit current_deposit{from, extended_asset(quantity, get_first_receiver()), memo};
 
             if (is_last_deposit(current_deposit, deposits))
-            {
-                std::pair<extended_symbol, extended_symbol> pool_pair = std::make_pair(deposits[0].quantity.get_extended_symbol(), deposits[1].quantity.get_extended_symbol());
+                complete_deposit(from, deposits);
+        }
+    }
+}
+
+void token::stage_deposit(const name &from, const extended_asset &quantity, std::string_view memo)
+{
+    check(quantity.get_extended_symbol() == USDT || quantity.get_extended_symbol() == MLNK, "stage_deposit : invalid deposit token");
 
-                checksum256 hash1 = to_pair_hash(pool_pair.first, pool_pair.second);
-                checksum256 hash2 = to_pair_hash(pool_pair.second, pool_pair.first);
+    //Every staged row holds at least one swap package, so staging can not be used to fill contract RAM for free
+    auto &_swap_table = ctx.get_swap_table();
+    const auto &swap_package = _swap_table.get(USDT.get_symbol().code().raw(), "no swap income object found");
+    const auto &swap_pckg_amount = swap_package.income.quantity.amount;
 
-                auto [pool, status] = get_pool(hash1, hash2);
-                check(status, "on_income : pool by hash is not exist");
-                
-                double pool_price = 0;
-                if (pool.token1.get_extended_symbol() == USDT)
-                    pool_price = (double)pool.token2.quantity.amount / (double)pool.token1.quantity.amount;
-                else
-                    pool_price = (double)pool.token1.quantity.amount / (double)pool.token2.quantity.amount;
+    if (quantity.get_extended_symbol() == USDT)
+        check(quantity.quantity.amount >= swap_pckg_amount && quantity.quantity.amount % swap_pckg_amount == 0, "stage_deposit : invalid USDT amount");
+    else
+        check(quantity.quantity.amount >= get_pool_price().apply_ceil(swap_pckg_amount), "stage_deposit : invalid MLNK amount");
 
-                auto [usdt_deposit, mlnk_deposit, usdt_rest, mlnk_rest] = validation_income_amount(deposits, pool_price);
+    auto &_staged_deposits = ctx.get_staged_deposits();
+    auto it = _staged_deposits.find(from.value);
+    if (it == _staged_deposits.end())
+    {
+        _staged_deposits.emplace(get_self(), [&](auto &s) {
+            s.owner = from;
+            s.quantity = quantity;
+            s.creation_date = time_point_sec(current_time_point().sec_since_epoch());
+        });
+    }
+    else if (it->quantity.get_extended_symbol() == quantity.get_extended_symbol())
+    {
+        _staged_deposits.modify(it, same_payer, [&](auto &s) {
+            s.quantity += quantity;
+            s.creation_date = time_point_sec(current_time_point().sec_since_epoch());
+        });
+    }
+    else
+    {
+        std::vector<deposit> deposits{{from, it->quantity, memo}, {from, quantity, memo}};
+        _staged_deposits.erase(it);
+        complete_deposit(from, deposits);
+    }
+}
 
-                if (usdt_rest.amount != 0)
-                    send_transfer(TETHER_ACCOUNT, from, usdt_rest, "deposit refund");
-                
-                if (mlnk_rest.amount != 0)
-                    send_transfer(SWAP_PCASH_ACCOUNT, from, mlnk_rest, "deposit refund");
+void token::refund_staged(const name &owner)
+{
+    auto &_staged_deposits = ctx.get_staged_deposits();
+    auto it = _staged_deposits.find(owner.value);
+    check(it != _staged_deposits.end(), "refund_staged : staged deposit is not exist");
 
-                check(is_account_exist(from, extended_symbol{USDCASH, get_self()}), "on_transfer : account is not exist");
-                send_issue(from, asset(usdt_deposit.amount * 10, USDCASH), "");
+    if (!has_auth(owner))
+        check(it->creation_date.sec_since_epoch() + staged_deposit_period < current_time_point().sec_since_epoch(),
+              "refund_staged : staged deposit is not expired");
 
-                create_deposit(from, usdt_deposit, mlnk_deposit, asset(usdt_deposit.amount * 10, USDCASH));
-            }
-        }
-    }
+    extended_asset quantity = it->quantity;
+    _staged_deposits.erase(it);
+
+    send_transfer(quantity.contract, owner, quantity.quantity, "deposit refund");
+}
+
+price_ratio token::get_pool_price()
+{
+    auto [pool, status] = get_pool();
+    check(status, "on_income : pool by hash is not exist");
+
+    if (pool.token1.get_extended_symbol() == USDT)
+        return price_ratio{pool.token2.quantity.amount, pool.token1.quantity.amount};
+    else
+        return price_ratio{pool.token1.quantity.amount, pool.token2.quantity.amount};
+}
+
+void token::complete_deposit(const name &from, const std::vector<deposit> &deposits)
+{
+    auto [usdt_deposit, mlnk_deposit, usdt_rest, mlnk_rest] = validation_income_amount(deposits, get_pool_price());
+
+    if (usdt_rest.amount != 0)
+        send_transfer(TETHER_ACCOUNT, from, usdt_rest, "deposit refund");
+    
+    if (mlnk_rest.amount != 0)
+        send_transfer(SWAP_PCASH_ACCOUNT, from, mlnk_rest, "deposit refund");
+
+    check(is_account_exist(from, extended_symbol{USDCASH, get_self()}), "on_transfer : account is not exist");
+    mint(from, asset(usdt_deposit.amount * 10, USDCASH));
+
+    create_deposit(from, usdt_deposit, mlnk_deposit, asset(usdt_deposit.amount * 10, USDCASH));
+
+    //Depositors carry a bounded share of the settlement, so the pending rows drain without a processrdm caller
+    redeem_deposits(deposit_settlement_rows);
 }
 
 void token::on_transfer_self_token(const name &from, const name &to, const asset &quantity, const std::string &memo)
 {
     if (to == get_self())
     {
-        reverse_table _reverse_table(get_self(), get_self().value);
+        auto &_reverse_table = ctx.get_reverse_table();
         auto r_it = _reverse_table.find(quantity.symbol.code().raw());
 
         check(r_it != _reverse_table.end(), "is not cash token");
@@ -458,73 +784,191 @@ void token::on_transfer_self_token(const name &from, const name &to, const asset
         if(quantity.symbol == USDCASH)
             check(quantity.amount >= r_it->cash.amount * exchange_multiplier, "invalid quantity amount");
 
-        swap_table _swap_table(get_self(), get_self().value);
+        auto &_swap_table = ctx.get_swap_table();
         const auto &swap_package = _swap_table.get(USDT.get_symbol().code().raw(), "no swap income object found");
         const auto &swap_pckg_amount = swap_package.income.quantity.amount;
 
-        deposits _deposits(get_self(), get_self().value);
-        auto index = _deposits.get_index<name("bymlnkdate")>();
+        auto &_deposits = ctx.get_deposits();
 
         if (memo == "usdt")
         {
             check(is_account_exist(from, extended_symbol{USDT}), "on_transfer : account is not exist");
 
-            asset sum = asset((double)quantity.amount / r_it->cash.amount * usdcash_package_amount, USDCASH);
-            asset usdt_sum = asset(0, USDT.get_symbol());
-
-            for (auto it = index.begin(); it != index.end();)
+            //Whole packages the book can not cover are returned to the sender
+            auto &book = ctx.get_redemption_book();
+            int64_t sum = mul_div(quantity.amount, usdcash_package_amount, r_it->cash.amount);
+            int64_t uncovered = sum - std::min(sum, book.total_cash());
+            int64_t refund_packages = (uncovered + usdcash_package_amount - 1) / usdcash_package_amount;
+            int64_t covered = sum - refund_packages * usdcash_package_amount;
+            check(covered > 0, "on_transfer : no deposits to redeem");
+
+            //Whole deposits are paid from the exact subtree sums, only the cut-off deposit is priced at its own ratio
+            auto cut = book.take_prefix(covered);
+            asset usdt_sum = asset(cut.usdt, USDT.get_symbol());
+            int64_t rest = covered - cut.cash;
+            if (rest != 0)
             {
-                if (sum.amount < it->token_out.amount)
-                {
-                    asset result_usdt = asset(sum.amount / 10, it->usdt_in.symbol);
-                    asset result_mlnk = asset(it->mlnk_in.amount / it->usdt_in.amount * result_usdt.amount, it->mlnk_in.symbol);
-                    usdt_sum += result_usdt;
-
-                    send_transfer(SWAP_PCASH_ACCOUNT, it->owner, result_mlnk, "return of the deposit");
-                    index.modify(it, same_payer, [&](auto &a) {
-                        a.token_out -= sum;
-                        a.usdt_in -= result_usdt;
-                        a.mlnk_in -= result_mlnk;
-                    });
-                    sum.amount = 0;
-                    break;
-                }
-                else if (sum.amount > it->token_out.amount)
-                {
-                    send_transfer(SWAP_PCASH_ACCOUNT, it->owner, it->mlnk_in, "return of the deposit");
-                    usdt_sum += it->usdt_in;
-                    sum -= it->token_out;
-                    index.erase(it);
-                    it = index.begin();
-                }
-                else
-                {
-                    send_transfer(SWAP_PCASH_ACCOUNT, it->owner, it->mlnk_in, "return of the deposit");
-                    usdt_sum += it->usdt_in;
-                    sum -= it->token_out;
-                    index.erase(it);
-                    break;
-                }
+                auto it = _deposits.find(book.front());
+                price_ratio part{rest, it->cash_amount};
+                int64_t usdt_amount = part.apply(it->usdt_amount);
+                int64_t mlnk_amount = part.apply(it->mlnk_amount);
+                usdt_sum.amount += usdt_amount;
+
+                add_claim(it->owner, asset(mlnk_amount, MLNK.get_symbol()));
+                _deposits.modify(it, same_payer, [&](auto &a) {
+                    a.cash_amount -= rest;
+                    a.usdt_amount -= usdt_amount;
+                    a.mlnk_amount -= mlnk_amount;
+                });
+                PERF_COUNT(deposits_modified, 1);
+                book.update(*it);
             }
-            if (sum.amount != 0)
-            {
-                asset rest = asset(sum.amount / usdcash_package_amount * r_it->cash.amount, r_it->cash.symbol);
 
-                send_transfer(get_self(), from, rest, "");
-                send_transfer(TETHER_ACCOUNT, from, usdt_sum, "");
-                send_retire(get_self(), quantity - rest, "");
-            }
-            else
+            if (cut.root != no_redemption_node)
             {
-                send_transfer(TETHER_ACCOUNT, from, usdt_sum, "");
-                send_retire(get_self(), quantity, "");
+                ctx.get_redemptions().emplace(get_self(), [&](auto &r) {
+                    r.id = cut.root;
+                });
             }
+
+            burn(get_self(), quantity);
+            if (refund_packages != 0)
+                mint(from, asset(refund_packages * r_it->cash.amount, quantity.symbol));
+
+            if (usdt_sum.amount != 0)
+                send_transfer(TETHER_ACCOUNT, from, usdt_sum, "");
+
+            redeem_deposits(max_redemption_rows);
         }
         else
             check(false, "invalid memo");
     }
 }
 
+void token::process_redemptions(const name &initiator, const uint32_t &max_rows)
+{
+    require_auth(initiator);
+    check(max_rows > 0 && max_rows <= max_redemption_rows, "process_redemptions : invalid rows amount");
+
+    auto &_redemptions = ctx.get_redemptions();
+    check(_redemptions.begin() != _redemptions.end(), "process_redemptions : no pending redemptions");
+
+    redeem_deposits(max_rows);
+}
+
+void token::swap_back_deposits(const name &user, const std::vector<swap_back_record> &records)
+{
+    check(is_account_exist(user, extended_symbol{USDT}), "swap_back : USDT account is not exist");
+    check(is_account_exist(user, extended_symbol{MLNK}), "swap_back : MLNK account is not exist");
+
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+    asset total_cash = asset(0, USDCASH);
+    asset send_usdt = asset(0, USDT.get_symbol());
+    asset send_mlnk = asset(0, MLNK.get_symbol());
+
+    for (const auto &record : records)
+    {
+        auto it = _deposits.find(record.id);
+        const asset &cash = record.cash;
+
+        check(it != _deposits.end(), "swap_back : deposit information is not found");
+        check(it->owner == user, "swap_back : the user is not the owner of the deposit");
+        check(cash.symbol == USDCASH, "swap_back : symbol precision mismatch");
+        check(cash.amount >= usdcash_package_amount && cash.amount % usdcash_package_amount == 0, "swap_back : invalid cash amount");
+        check(cash.amount <= it->cash_amount, "swap_back : cash amount must be less then deposit amount");
+        check(!book.is_reserved(it->id), "swap_back : deposit is being redeemed");
+
+        price_ratio rate{cash.amount, it->cash_amount};
+        int64_t mlnk_amount = rate.apply(it->mlnk_amount);
+        int64_t usdt_amount = rate.apply(it->usdt_amount);
+
+        if (it->cash_amount == cash.amount)
+        {
+            if (book.contains(it->id))
+                book.erase(it->id);
+            _deposits.erase(it);
+            PERF_COUNT(deposits_erased, 1);
+        }
+        else
+        {
+            _deposits.modify(it, same_payer, [&](auto &a) {
+                a.cash_amount -= cash.amount;
+                a.usdt_amount -= usdt_amount;
+                a.mlnk_amount -= mlnk_amount;
+            });
+            PERF_COUNT(deposits_modified, 1);
+            book.update(*it);
+        }
+
+        total_cash += cash;
+        send_usdt.amount += usdt_amount;
+        send_mlnk.amount += mlnk_amount;
+    }
+
+    burn(user, total_cash);
+    send_transfer(TETHER_ACCOUNT, user, send_usdt, "");
+    send_transfer(SWAP_PCASH_ACCOUNT, user, send_mlnk, "");
+}
+
+void token::redeem_deposits(uint32_t max_rows)
+{
+    PROBE("redeem_deposits");
+    auto &_redemptions = ctx.get_redemptions();
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+
+    //Every settled node hands its children over as new pending roots, so each deposit costs one row
+    for (; max_rows > 0 && _redemptions.begin() != _redemptions.end(); --max_rows)
+    {
+        PERF_COUNT(redemption_iterations, 1);
+        auto r_it = _redemptions.begin();
+        uint64_t id = r_it->id;
+        _redemptions.erase(r_it);
+
+        for (const auto &child : book.release(id))
+        {
+            _redemptions.emplace(get_self(), [&](auto &r) {
+                r.id = child;
+            });
+        }
+
+        const auto &deposit = _deposits.get(id, "redeem_deposits : deposit is not found");
+        add_claim(deposit.owner, deposit.get_mlnk_in());
+        _deposits.erase(deposit);
+        PERF_COUNT(deposits_erased, 1);
+    }
+}
+
+void token::add_claim(const name &owner, const asset &quantity)
+{
+    if (quantity.amount == 0)
+        return;
+
+    auto &_claims = ctx.get_claims();
+    auto it = _claims.find(owner.value);
+    if (it == _claims.end())
+    {
+        _claims.emplace(get_self(), [&](auto &c) {
+            c.owner = owner;
+            c.quantity = quantity;
+        });
+    }
+    else
+    {
+        _claims.modify(it, same_payer, [&](auto &c) {
+            c.quantity += quantity;
+        });
+    }
+}
+
+void token::log_events(const std::vector<event> &events)
+{
+    require_auth(get_self());
+    for (const auto &e : events)
+        require_recipient(e.to);
+}
+
 void token::notify(const std::string &action_type, const name &to, const name &from, const asset &quantity, const std::string &memo)
 {
     require_auth(get_self());
@@ -533,7 +977,8 @@ void token::notify(const std::string &action_type, const name &to, const name &f
 
 void token::sub_balance(const name &owner, const asset &value)
 {
-    accounts from_acnts(get_self(), owner.value);
+    PROBE("sub_balance");
+    auto &from_acnts = ctx.get_accounts(owner);
 
     const auto &from = from_acnts.get(value.symbol.code().raw(), "no balance object found");
     check(from.balance.amount >= value.amount, "overdrawn balance");
@@ -543,9 +988,47 @@ void token::sub_balance(const name &owner, const asset &value)
     });
 }
 
+void token::mint(const name &to, const asset &quantity)
+{
+    auto sym_code_raw = quantity.symbol.code().raw();
+    auto &statstable = ctx.get_stats(sym_code_raw);
+    const auto &st = statstable.get(sym_code_raw, "mint : token with symbol does not exist");
+
+    check(quantity.is_valid(), "mint : invalid quantity");
+    check(quantity.amount > 0, "mint : must issue positive quantity");
+    check(quantity.symbol == st.supply.symbol, "mint : symbol precision mismatch");
+    check(quantity.amount <= st.max_supply.amount - st.supply.amount, "mint : quantity exceeds available supply");
+
+    statstable.modify(st, same_payer, [&](auto &s) {
+        s.supply += quantity;
+    });
+
+    add_balance(to, quantity, get_self());
+    emit_event(issue_event, to, get_self(), quantity);
+}
+
+void token::burn(const name &owner, const asset &quantity)
+{
+    auto sym_code_raw = quantity.symbol.code().raw();
+    auto &statstable = ctx.get_stats(sym_code_raw);
+    const auto &st = statstable.get(sym_code_raw, "burn : token with symbol does not exist");
+
+    check(quantity.is_valid(), "burn : invalid quantity");
+    check(quantity.amount > 0, "burn : must retire positive quantity");
+    check(quantity.symbol == st.supply.symbol, "burn : symbol precision mismatch");
+
+    statstable.modify(st, same_payer, [&](auto &s) {
+        s.supply -= quantity;
+    });
+
+    sub_balance(owner, quantity);
+    emit_event(retire_event, owner, get_self(), -quantity);
+}
+
 void token::add_balance(const name &owner, const asset &value, const name &ram_payer)
 {
-    accounts to_acnts(get_self(), owner.value);
+    PROBE("add_balance");
+    auto &to_acnts = ctx.get_accounts(owner);
     auto to = to_acnts.find(value.symbol.code().raw());
     if (to == to_acnts.end())
     {
@@ -565,38 +1048,65 @@ void token::add_balance(const name &owner, const asset &value, const name &ram_p
 
 void token::distribute_royalty(const asset &quantity)
 {
-    accounts from_acnts(MLNK.get_contract(), get_self().value);
-    royalties _royalties(get_self(), get_self().value);
-
     check(quantity.amount >= 1000, "distribute_royalty : invalid distribution token amount");
 
-    asset distributed_sum = asset(0, quantity.symbol);
+    auto &_royalty_pools = ctx.get_royalty_pools();
+    auto it = _royalty_pools.find(quantity.symbol.code().raw());
+    uint128_t increment = (uint128_t)quantity.amount * royalty_precision / max_percent.amount;
 
-    for (const auto &i : _royalties)
+    if (it == _royalty_pools.end())
+    {
+        _royalty_pools.emplace(get_self(), [&](auto &r) {
+            r.total = quantity;
+            r.reward_per_share = increment;
+        });
+    }
+    else
     {
-        auto value = count_share(quantity, i.get_royalty());
-        send_transfer(MLNK.get_contract(), i.get_account(), value, "royalty");
-        distributed_sum += value;
+        _royalty_pools.modify(it, same_payer, [&](auto &r) {
+            r.total += quantity;
+            r.reward_per_share += increment;
+        });
     }
-    send_notify("royalty", get_self(), name(), -distributed_sum, "Total amount of distribution: " + quantity.to_string());
+    emit_event(royalty_event, get_self(), name(), -quantity);
+}
+
+uint128_t token::get_reward_per_share(const symbol &sym)
+{
+    auto &_royalty_pools = ctx.get_royalty_pools();
+    auto it = _royalty_pools.find(sym.code().raw());
+    return it != _royalty_pools.end() ? it->reward_per_share : 0;
+}
+
+int64_t token::count_royalty(const royalty_holder &holder, const uint128_t &reward_per_share)
+{
+    uint128_t accrued = (reward_per_share - holder.get_checkpoint()) * (uint128_t)holder.get_royalty().amount / royalty_precision;
+    return holder.get_pending() + (int64_t)accrued;
 }
 
-std::tuple<pool, bool> token::get_pool(const checksum256 &hash1, const checksum256 &hash2)
+std::tuple<pool, bool> token::get_pool()
 {
+    PROBE("get_pool");
     pools _pools(SWAP_PCASH_ACCOUNT, SWAP_PCASH_ACCOUNT.value);
-    auto index = _pools.get_index<name("bypair")>();
+    pool_refs _pool_refs(get_self(), get_self().value);
 
-    auto it = index.find(hash1);
-    if (it != index.end())
-        return std::make_tuple(*it, true);
-    else
+    auto ref = _pool_refs.get_or_default(pool_ref{no_pool_id});
+    if (ref.pool_id != no_pool_id)
     {
-        it = index.find(hash2);
-        if (it != index.end())
+        auto it = _pools.find(ref.pool_id);
+        if (it != _pools.end() && it->has_pair(MLNK, USDT))
             return std::make_tuple(*it, true);
-        else
-            return std::make_tuple(pool(), false);
     }
+
+    auto index = _pools.get_index<name("bypair")>();
+    auto it = index.find(to_pair_hash(MLNK, USDT));
+    if (it == index.end())
+        it = index.find(to_pair_hash(USDT, MLNK));
+    if (it == index.end())
+        return std::make_tuple(pool(), false);
+
+    _pool_refs.set(pool_ref{it->id}, get_self());
+    return std::make_tuple(*it, true);
 }
 
 bool token::is_valid_inactive_period(const uint32_t &inactive_period)
@@ -658,28 +1168,79 @@ bool token::is_valid_inheritors(const std::vector<inheritor_record> &inheritors)
 
 asset token::count_share(const asset &quantity, const asset &share)
 {
-    double result = (double)quantity.amount * (double)share.amount;
-    result /= (double)max_percent.amount;
-    return asset(result, quantity.symbol);
+    return asset(mul_div(quantity.amount, share.amount, max_percent.amount), quantity.symbol);
+}
+
+bool token::is_valid_royalties_sum(const asset &sum)
+{
+    return (sum <= max_percent) ? true : false;
 }
 
-bool token::is_valid_royalties_sum(const asset &share)
+asset token::get_royalties_sum()
 {
-    royalties _royalties(get_self(), get_self().value);
+    royalty_sums _royalty_sums(get_self(), get_self().value);
+    if (_royalty_sums.exists())
+        return _royalty_sums.get().total;
 
+    //Deployments without the cached sum count it once
     asset sum(0, inh_percent);
-    for (const auto &it : _royalties)
-    {
+    for (const auto &it : ctx.get_royalties())
         sum += it.get_royalty();
+    return sum;
+}
+
+void token::set_royalties_sum(const asset &sum)
+{
+    //Holders paid later in a running round would get shares that differ from the ones paid earlier
+    royalty_rounds _rounds(get_self(), get_self().value);
+    check(!_rounds.exists(), "set_royalties_sum : royalty round is in progress");
+
+    royalty_sums _royalty_sums(get_self(), get_self().value);
+    _royalty_sums.set(royalty_sum{sum}, get_self());
+}
+
+asset token::put_royalty_holder(const name &user_name, const asset &royalty, const uint128_t &reward_per_share)
+{
+    auto &_royalties = ctx.get_royalties();
+    auto it = _royalties.find(user_name.value);
+    if (it == _royalties.end())
+    {
+        auto current_day = get_current_day();
+        _royalties.emplace(get_self(), [&](auto &r) {
+            royalty_holder temp(current_day, user_name, royalty);
+            temp.set_checkpoint(reward_per_share, 0);
+            r = temp;
+        });
+        return asset(0, inh_percent);
     }
-    sum += share;
 
-    return (sum <= max_percent) ? true : false;
+    auto previous = it->get_royalty();
+    auto pending = count_royalty(*it, reward_per_share);
+    _royalties.modify(it, same_payer, [&](auto &r) {
+        r.set_royalty(royalty);
+        r.set_checkpoint(reward_per_share, pending);
+    });
+    return previous;
+}
+
+asset token::erase_royalty_holder(const name &user_name, const uint128_t &reward_per_share)
+{
+    auto &_royalties = ctx.get_royalties();
+    auto it = _royalties.find(user_name.value);
+    check(it != _royalties.end(), "rmv_royalty_holder : account not exist");
+
+    auto previous = it->get_royalty();
+    auto pending = count_royalty(*it, reward_per_share);
+    if (pending > 0)
+        send_transfer(MLNK.get_contract(), it->get_account(), asset(pending, MLNK.get_symbol()), "royalty");
+
+    _royalties.erase(it);
+    return previous;
 }
 
 void token::create_inheritance(const name &owner, const name &ram_payer)
 {
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto it = _inheritance.find(owner.value);
     if (it == _inheritance.end())
     {
@@ -694,7 +1255,7 @@ void token::create_inheritance(const name &owner, const name &ram_payer)
 
 void token::close_inheritance(const name &owner)
 {
-    inheritance _inheritance(get_self(), get_self().value);
+    auto &_inheritance = ctx.get_inheritance();
     auto inh = _inheritance.find(owner.value);
     if (inh != _inheritance.end())
     {
@@ -704,18 +1265,37 @@ void token::close_inheritance(const name &owner)
 
 void token::extend_inheritance(const name &owner, const name &ram_payer)
 {
-    inheritance _inheritance(get_self(), get_self().value);
+    PROBE("extend_inheritance");
+    auto &_inheritance = ctx.get_inheritance();
     auto it = _inheritance.find(owner.value);
     if (it != _inheritance.end())
     {
         time_point_sec new_inh_date(current_time_point().sec_since_epoch() + it->inactive_period);
 
-        _inheritance.modify(it, ram_payer, [&](auto &r) {
-            r.inheritance_date = new_inh_date;
-        });
+        if (new_inh_date.sec_since_epoch() > it->inheritance_date.sec_since_epoch() + inh_extend_tolerance)
+        {
+            _inheritance.modify(it, ram_payer, [&](auto &r) {
+                r.inheritance_date = new_inh_date;
+            });
+        }
     }
 }
 
+void token::distribute_balance(const member &owner, const asset &balance, const name &ram_payer)
+{
+    auto value = balance;
+    if (owner.inheritors.size() == 1 && owner.inheritors.back().inheritor == get_self())
+    {
+        add_inh_balance(owner.user_name, get_self(), value, ram_payer);
+    }
+    else
+    {
+        add_inh_balances(owner.user_name, value, owner.inheritors, ram_payer);
+    }
+    sub_balance(owner.user_name, value);
+    emit_event(inheritance_event, owner.user_name, name(), -value);
+}
+
 void token::add_inh_balances(const name &owner, const asset &value, const std::vector<inheritor_record> &inheritors, const name &ram_payer)
 {
     send_inheritance(owner, value, inheritors, 1, ram_payer);
@@ -724,7 +1304,7 @@ void token::add_inh_balances(const name &owner, const asset &value, const std::v
 void token::add_inh_balance(const name &from, const name &to, const asset &value, const name &ram_payer)
 {
     add_balance(to, value, ram_payer);
-    send_notify("inheritance", to, from, value, "");
+    emit_event(inheritance_event, to, from, value);
 }
 
 void token::send_inheritance(const name &owner, const asset &quantity,
@@ -770,27 +1350,27 @@ bool token::is_valid_deposits(const std::vector<deposit> &deposits)
 }
 
 std::vector<deposit>
-token::parse_deposit_actions(const transaction &trx)
+token::parse_deposit_actions(const std::vector<char> &trx)
 {
+    PROBE("parse_deposit_actions");
     std::vector<deposit> result;
+    transaction_reader reader(trx.data(), trx.size());
+    transfer_view transfer;
 
-    for (auto act : trx.actions)
+    while (reader.next_transfer(transfer))
     {
-        if (act.name == name("transfer"))
+        if (transfer.to == get_self())
         {
-            auto data = act.data_as<transfer_action>();
-            if (data.to == get_self())
-            {
-                result.push_back({data.from, extended_asset(data.quantity, act.account), data.memo});
-            }
+            result.push_back({transfer.from, extended_asset(transfer.quantity, transfer.account), transfer.memo});
         }
     }
 
     return result;
 }
 
-std::tuple<asset, asset, asset, asset> token::validation_income_amount(const std::vector<deposit> &deposits, const double &pool_price)
+std::tuple<asset, asset, asset, asset> token::validation_income_amount(const std::vector<deposit> &deposits, const price_ratio &pool_price)
 {
+    PROBE("validation_income_amount");
     asset income_usdt = asset();
     asset income_mlnk = asset();
 
@@ -805,11 +1385,11 @@ std::tuple<asset, asset, asset, asset> token::validation_income_amount(const std
         income_mlnk = deposits[0].quantity.quantity;
     }
 
-    swap_table _swap_table(get_self(), get_self().value);
+    auto &_swap_table = ctx.get_swap_table();
     const auto &swap_package = _swap_table.get(income_usdt.symbol.code().raw(), "no swap income object found");
     const auto &swap_pckg_amount = swap_package.income.quantity.amount;
     
-    int64_t mlnk_in_swap_pckg_amount = ceil(swap_pckg_amount * pool_price);
+    int64_t mlnk_in_swap_pckg_amount = pool_price.apply_ceil(swap_pckg_amount);
 
     if (income_usdt.amount >= swap_pckg_amount && income_mlnk.amount >= mlnk_in_swap_pckg_amount)
     {
@@ -822,27 +1402,45 @@ std::tuple<asset, asset, asset, asset> token::validation_income_amount(const std
         check(false, "invalid income amount");
 }
 
-transaction token::get_income_trx()
+std::vector<char> token::get_income_trx()
 {
+    PROBE("get_income_trx");
     auto size = transaction_size();
-    char buff[size];
-    auto readed_size = read_transaction(buff, size);
+    std::vector<char> buff(size);
+    auto readed_size = read_transaction(buff.data(), size);
     check(readed_size == size, "get_income_trx : read transaction failed");
-    transaction trx = unpack<transaction>(buff, size);
-    return trx;
+    return buff;
 }
 
 void token::create_deposit(const name &owner, const asset &usdt, const asset mlnk, const asset &cash)
 {
-    deposits _deposits(get_self(), get_self().value);
-    _deposits.emplace(get_self(), [&](auto &a) {
+    auto &_deposits = ctx.get_deposits();
+    auto &book = ctx.get_redemption_book();
+    auto owner_index = _deposits.get_index<name("byowner")>();
+    for (auto same = owner_index.lower_bound(owner.value); same != owner_index.end() && same->owner == owner; ++same)
+    {
+        if ((uint128_t)same->mlnk_amount * usdt.amount != (uint128_t)same->usdt_amount * mlnk.amount || book.is_reserved(same->id))
+            continue;
+
+        owner_index.modify(same, same_payer, [&](auto &a) {
+            a.mlnk_amount += mlnk.amount;
+            a.usdt_amount += usdt.amount;
+            a.cash_amount += cash.amount;
+        });
+        PERF_COUNT(deposits_modified, 1);
+        book.update(*same);
+        return;
+    }
+
+    auto it = _deposits.emplace(get_self(), [&](auto &a) {
         a.id = _deposits.available_primary_key();
         a.owner = owner;
-        a.mlnk_in = mlnk;
-        a.usdt_in = usdt;
-        a.token_out = cash;
+        a.mlnk_amount = mlnk.amount;
+        a.usdt_amount = usdt.amount;
+        a.cash_amount = cash.amount;
         a.creation_date = time_point_sec(current_time_point().sec_since_epoch());
     });
+    book.insert(*it);
 }
 
 bool token::is_last_deposit(const deposit &current_deposit, const std::vector<deposit> &deposits)
@@ -852,7 +1450,7 @@ bool token::is_last_deposit(const deposit &current_deposit, const std::vector<de
 
 bool token::is_account_exist(const name &owner, const extended_symbol &token)
 {
-    accounts _accounts(token.get_contract(), owner.value);
+    auto &_accounts = ctx.get_accounts(token.get_contract(), owner);
     auto it = _accounts.find(token.get_symbol().code().raw());
     return it != _accounts.end() ? true : false;
 }
@@ -872,34 +1470,140 @@ void token::send_transfer(const name &contract, const name &to, const asset &qua
         name("transfer"),
         std::make_tuple(get_self(), to, quantity, memo))
         .send();
+    PERF_COUNT(inline_transfers, 1);
 }
 
-void token::send_issue(const name &to, const asset &quantity, const std::string &memo)
+void token::emit_event(const event_type &type, const name &to, const name &from, const asset &quantity)
 {
-    action(
-        permission_level{get_self(), name("active")},
-        get_self(),
-        name("issue"),
-        std::make_tuple(to, quantity, memo))
-        .send();
+    pending_events.push_back({type, to, from, quantity});
 }
 
-void token::send_retire(const name &owner, const asset &quantity, const std::string &memo)
+void token::send_events()
 {
+    if (pending_events.empty())
+        return;
+
     action(
         permission_level{get_self(), name("active")},
         get_self(),
-        name("retire"),
-        std::make_tuple(owner, quantity, memo))
+        name("events"),
+        std::make_tuple(pending_events))
         .send();
+    PERF_COUNT(notify_actions, 1);
+    pending_events.clear();
 }
 
-void token::send_notify(const std::string &action_type, const name &to, const name &from, const asset &quantity, const std::string &memo)
+#ifdef PERF_COUNTERS
+void token::reset_perf_counters()
 {
-    action(
-        permission_level{get_self(), name("active")},
-        get_self(),
-        name("notify"),
-        std::make_tuple(action_type, to, from, quantity, memo))
-        .send();
-}
\ No newline at end of file
+    require_auth(get_self());
+    perf_counters _perf_counters(get_self(), get_self().value);
+    _perf_counters.remove();
+    perf = perf_values{};
+}
+
+void token::save_perf_counters()
+{
+    if (perf_action == name("resetperf"))
+        return;
+
+    perf_counters _perf_counters(get_self(), get_self().value);
+    auto counters = _perf_counters.get_or_default(perf_counter{});
+    counters.total += perf;
+
+    auto mark = std::find_if(counters.marks.begin(), counters.marks.end(), [](const auto &m) {
+        return m.code == perf_code && m.action == perf_action;
+    });
+    if (mark == counters.marks.end())
+        counters.marks.push_back(perf_mark{perf_code, perf_action, perf});
+    else
+        mark->max.raise_to(perf);
+
+    _perf_counters.set(counters, get_self());
+}
+#endif
+
+void on_transfer_notify(const name &receiver, const name &code)
+{
+    //from and to are decoded first, anything but an incoming payment is rejected before the memo is read
+    char header[2 * sizeof(uint64_t)];
+    if (action_data_size() < sizeof(header))
+        return;
+    read_action_data(header, sizeof(header));
+
+    name from, to;
+    datastream<const char *> head(header, sizeof(header));
+    head >> from >> to;
+    if (to != receiver || (from != MLNK_ACCOUNT && code != SWAP_PCASH_ACCOUNT && code != TETHER_ACCOUNT))
+        return;
+
+    std::vector<char> buffer(action_data_size());
+    read_action_data(buffer.data(), buffer.size());
+
+    asset quantity;
+    unsigned_int memo_size;
+    datastream<const char *> ds(buffer.data(), buffer.size());
+    ds.skip(sizeof(header));
+    ds >> quantity >> memo_size;
+    check(memo_size.value <= ds.remaining(), "on_transfer : invalid memo");
+    std::string_view memo(ds.pos(), memo_size.value);
+
+    token contract(receiver, code, datastream<const char *>(buffer.data(), buffer.size()));
+    contract.on_transfer(from, to, quantity, memo);
+}
+
+extern "C"
+{
+    void apply(uint64_t receiver, uint64_t code, uint64_t action)
+    {
+#ifdef PERF_COUNTERS
+        perf_code = name(code);
+        perf_action = name(action);
+#endif
+        if (code != receiver)
+        {
+            if (action == name("transfer").value)
+                on_transfer_notify(name(receiver), name(code));
+            return;
+        }
+
+        switch (action)
+        {
+        case name("migration").value: execute_action(name(receiver), name(code), &token::migrate_deposits); break;
+        case name("sweepdust").value: execute_action(name(receiver), name(code), &token::sweep_dust); break;
+        case name("setinhdate").value: execute_action(name(receiver), name(code), &token::set_inheritance_date); break;
+        case name("addswapinc").value: execute_action(name(receiver), name(code), &token::add_swap_income); break;
+        case name("addswapcash").value: execute_action(name(receiver), name(code), &token::add_swap_cash); break;
+        case name("create").value: execute_action(name(receiver), name(code), &token::create_token); break;
+        case name("issue").value: execute_action(name(receiver), name(code), &token::issue_token); break;
+        case name("retire").value: execute_action(name(receiver), name(code), &token::retire_token); break;
+        case name("transfer").value: execute_action(name(receiver), name(code), &token::transfer_token); break;
+        case name("transfermany").value: execute_action(name(receiver), name(code), &token::transfer_many); break;
+        case name("open").value: execute_action(name(receiver), name(code), &token::open_account); break;
+        case name("close").value: execute_action(name(receiver), name(code), &token::close_account); break;
+        case name("distrmlnk").value: execute_action(name(receiver), name(code), &token::distribute_mlnk); break;
+        case name("getroyalties").value: execute_action(name(receiver), name(code), &token::get_royalties); break;
+        case name("clrroyround").value: execute_action(name(receiver), name(code), &token::clear_royalty_round); break;
+        case name("swapback").value: execute_action(name(receiver), name(code), &token::swap_back); break;
+        case name("swapbacks").value: execute_action(name(receiver), name(code), &token::swap_back_many); break;
+        case name("swapbackall").value: execute_action(name(receiver), name(code), &token::swap_back_all); break;
+        case name("refundstage").value: execute_action(name(receiver), name(code), &token::refund_staged); break;
+        case name("processrdm").value: execute_action(name(receiver), name(code), &token::process_redemptions); break;
+        case name("claim").value: execute_action(name(receiver), name(code), &token::claim_deposit); break;
+        case name("addrlthldr").value: execute_action(name(receiver), name(code), &token::add_royalty_holder); break;
+        case name("rmvrlthldr").value: execute_action(name(receiver), name(code), &token::rmv_royalty_holder); break;
+        case name("setroyalties").value: execute_action(name(receiver), name(code), &token::set_royalties); break;
+        case name("claimroyalty").value: execute_action(name(receiver), name(code), &token::claim_royalty); break;
+        case name("dstrinh").value: execute_action(name(receiver), name(code), &token::distribute_inheritance); break;
+        case name("processinh").value: execute_action(name(receiver), name(code), &token::process_inheritances); break;
+        case name("updinhdate").value: execute_action(name(receiver), name(code), &token::update_inheritance_date); break;
+        case name("updtokeninhs").value: execute_action(name(receiver), name(code), &token::update_inheritors); break;
+        case name("events").value: execute_action(name(receiver), name(code), &token::log_events); break;
+        case name("notify").value: execute_action(name(receiver), name(code), &token::notify); break;
+#ifdef PERF_COUNTERS
+        case name("resetperf").value: execute_action(name(receiver), name(code), &token::reset_perf_counters); break;
+#endif
+        default: check(false, "unknown action");
+        }
+    }
+}
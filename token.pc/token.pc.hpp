@@ -3,17 +3,29 @@
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
 #include <eosio/transaction.hpp>
-#include <math.h>
 #include <algorithm>
+#include <map>
 #include <string>
 #include "account.hpp"
 #include "stat.hpp"
 #include "royalty_holder.hpp"
+#include "royalty_pool.hpp"
 #include "inheritance.hpp"
 #include "pool.hpp"
 #include "reverse.hpp"
 #include "income.hpp"
 #include "deposit.hpp"
+#include "muldiv.hpp"
+#include "transaction_reader.hpp"
+#include "events.hpp"
+#include "state_context.hpp"
+#include "redemption.hpp"
+#include "redemption_tree.hpp"
+#include "redemption_book.hpp"
+#include "claim.hpp"
+#include "staged_deposit.hpp"
+#include "perf_counters.hpp"
+#include "probe.hpp"
 
 
 using namespace eosio;
@@ -22,8 +34,11 @@ class [[eosio::contract("token.pc")]] token : public contract
 {
 public:
     token(name receiver, name code, datastream<const char *> ds);
+    ~token();
 
-    [[eosio::action("migration")]] void migration_data(const uint64_t &id);
+    [[eosio::action("migration")]] void migrate_deposits(const uint32_t &max_rows);
+
+    [[eosio::action("sweepdust")]] void sweep_dust(const uint64_t &lower_id, const uint32_t &max_rows);
 
     [[eosio::action("setinhdate")]] void set_inheritance_date(const name &owner, const uint32_t &date);
     
@@ -41,51 +56,103 @@ public:
 
     [[eosio::action("transfer")]] void transfer_token(const name &from, const name &to, const asset &quantity, const std::string &memo);
 
+    [[eosio::action("transfermany")]] void transfer_many(const name &from, const std::vector<transfer_record> &transfers);
+
     [[eosio::action("open")]] void open_account(const name &owner, const symbol &symbol, const name &ram_payer);
 
     [[eosio::action("close")]] void close_account(const name &owner, const symbol &symbol);
 
     [[eosio::action("distrmlnk")]] void distribute_mlnk();
 
-    [[eosio::action("getroyalties")]] void get_royalties(const name &ram_payer);
+    [[eosio::action("getroyalties")]] void get_royalties(const name &ram_payer, const uint32_t &max_rows);
+
+    [[eosio::action("clrroyround")]] void clear_royalty_round();
 
     [[eosio::action("swapback")]] void swap_back(const name &user, const asset &cash, const uint64_t &id);
 
+    [[eosio::action("swapbacks")]] void swap_back_many(const name &user, const std::vector<swap_back_record> &records);
+
+    [[eosio::action("swapbackall")]] void swap_back_all(const name &user, const asset &cash);
+
+    [[eosio::action("refundstage")]] void refund_staged(const name &owner);
+
+    //For settling redeemed deposits, returns their MLNK to the owners claims.
+    //Anyone may run it, depositors waiting for their claim are expected to, every new deposit also settles a few rows
+    [[eosio::action("processrdm")]] void process_redemptions(const name &initiator, const uint32_t &max_rows);
+
+    //For withdrawing MLNK returned by redemptions
+    [[eosio::action("claim")]] void claim_deposit(const name &user_name);
+
     //For royalties managing
     [[eosio::action("addrlthldr")]] void add_royalty_holder(const name &user_name, const asset &royalty);
 
     [[eosio::action("rmvrlthldr")]] void rmv_royalty_holder(const name &user_name);
 
+    [[eosio::action("setroyalties")]] void set_royalties(const std::vector<royalty_record> &holders, const bool &replace);
+
+    [[eosio::action("claimroyalty")]] void claim_royalty(const name &user_name);
+
     //For init inheritance distribution
     [[eosio::action("dstrinh")]] void distribute_inheritance(const name &initiator, const name &inheritance_owner, const symbol_code &token);
 
+    [[eosio::action("processinh")]] void process_inheritances(const name &initiator, const uint32_t &max_rows);
+
     //For inheritor programm
     [[eosio::action("updinhdate")]] void update_inheritance_date(const name &owner, const uint32_t &inactive_period);
 
     [[eosio::action("updtokeninhs")]] void update_inheritors(const name &owner, const std::vector<inheritor_record> &inheritors);
 
-    //For incoming payments
-    [[eosio::on_notify("*::transfer")]] void on_transfer(const name &from, const name &to, const asset &quantity, const std::string &memo);
+    //For incoming payments, dispatched by apply after the early reject of foreign transfers
+    void on_transfer(const name &from, const name &to, const asset &quantity, std::string_view memo);
 
     //For notifing
+    [[eosio::action("events")]] void log_events(const std::vector<event> &events);
+
     [[eosio::action("notify")]] void notify(const std::string &action_type, const name &to, const name &from,
                                             const asset &quantity, const std::string &memo);
 
+#ifdef PERF_COUNTERS
+    [[eosio::action("resetperf")]] void reset_perf_counters();
+#endif
+
 private:
+    std::vector<event> pending_events;
+    state_context ctx;
+
+#ifdef PERF_COUNTERS
+    perf_values perf;
+
+    void save_perf_counters();
+#endif
+
     void on_transfer_self_token(const name &from, const name &to, const asset &quantity, const std::string &memo);
 
+    void redeem_deposits(uint32_t max_rows);
+    void swap_back_deposits(const name &user, const std::vector<swap_back_record> &records);
+    void add_claim(const name &owner, const asset &quantity);
+
     void sub_balance(const name &owner, const asset &value);
     void add_balance(const name &owner, const asset &value, const name &ram_payer);
 
+    void mint(const name &to, const asset &quantity);
+    void burn(const name &owner, const asset &quantity);
+
     void distribute_royalty(const asset &quantity);
+    uint128_t get_reward_per_share(const symbol &sym);
+    int64_t count_royalty(const royalty_holder &holder, const uint128_t &reward_per_share);
 
-    std::tuple<pool, bool> get_pool(const checksum256 &hash1, const checksum256 &hash2);
+    std::tuple<pool, bool> get_pool();
+    price_ratio get_pool_price();
 
     asset count_share(const asset &quantity, const asset &share);
     bool is_valid_share(const asset &share);
     bool is_valid_share_sum(const asset &sum);
     bool is_valid_inheritors(const std::vector<inheritor_record> &inheritors);
-    bool is_valid_royalties_sum(const asset &share);
+    bool is_valid_royalties_sum(const asset &sum);
+    asset get_royalties_sum();
+    void set_royalties_sum(const asset &sum);
+    asset put_royalty_holder(const name &user_name, const asset &royalty, const uint128_t &reward_per_share);
+    asset erase_royalty_holder(const name &user_name, const uint128_t &reward_per_share);
 
     bool is_valid_inactive_period(const uint32_t &inactive_period);
     bool is_not_self_in_inheritors(const name &owner, const std::vector<inheritor_record> &inheritors);
@@ -96,6 +163,7 @@ private:
     void close_inheritance(const name &owner);
     void extend_inheritance(const name &owner, const name &ram_payer);
 
+    void distribute_balance(const member &owner, const asset &balance, const name &ram_payer);
     void add_inh_balances(const name &owner, const asset &value, const std::vector<inheritor_record> &inheritors, const name &ram_payer);
     void add_inh_balance(const name &from, const name &to, const asset &value, const name &ram_payer);
 
@@ -105,10 +173,12 @@ private:
     time_point_sec get_inheritance_exp_date(const uint32_t &inactive_period);
 
     bool is_valid_deposits(const std::vector<deposit> &deposits);
-    std::vector<deposit> parse_deposit_actions(const transaction &trx);
-    std::tuple<asset, asset, asset, asset> validation_income_amount(const std::vector<deposit> &deposits, const double &pool_price);
-    transaction get_income_trx();
+    std::vector<deposit> parse_deposit_actions(const std::vector<char> &trx);
+    std::tuple<asset, asset, asset, asset> validation_income_amount(const std::vector<deposit> &deposits, const price_ratio &pool_price);
+    std::vector<char> get_income_trx();
 
+    void stage_deposit(const name &from, const extended_asset &quantity, std::string_view memo);
+    void complete_deposit(const name &from, const std::vector<deposit> &deposits);
     void create_deposit(const name &owner, const asset &usdt, const asset mlnk, const asset &cash);
     bool is_last_deposit(const deposit &current_deposit, const std::vector<deposit> &deposits);
     bool is_account_exist(const name &owner, const extended_symbol &token);
@@ -116,7 +186,6 @@ private:
     time_point_sec get_current_day();
 
     void send_transfer(const name &contract, const name &to, const asset &quantity, const std::string &memo);
-    void send_issue(const name &to, const asset &quantity, const std::string &memo);
-    void send_retire(const name &owner, const asset &quantity, const std::string &memo);
-    void send_notify(const std::string &action_type, const name &to, const name &from, const asset &quantity, const std::string &memo);
+    void emit_event(const event_type &type, const name &to, const name &from, const asset &quantity);
+    void send_events();
 };